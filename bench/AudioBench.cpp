@@ -0,0 +1,108 @@
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AudioSystem.h"
+
+// Plays looping music with a voice line restarted every half second while the
+// main thread stalls the way a large texture upload would, then reports how
+// often the device callback found a streaming channel's ring empty. Uses the
+// dummy driver, which paces callbacks in real time without sound hardware.
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const int runSeconds = 4;
+const int voiceIntervalMs = 500;
+const int stallMs[] = {40, 120, 250, 16, 300, 80};
+
+bool WriteTone(const std::string& path, int rate, int channels, float seconds, float hz) {
+    SDL_IOStream* io = SDL_IOFromFile(path.c_str(), "wb");
+    if (!io) {
+        return false;
+    }
+
+    Uint32 frames = static_cast<Uint32>(rate * seconds);
+    Uint32 dataSize = frames * channels * sizeof(Sint16);
+    bool ok = SDL_WriteIO(io, "RIFF", 4) == 4 && SDL_WriteU32LE(io, 36 + dataSize) &&
+              SDL_WriteIO(io, "WAVEfmt ", 8) == 8 && SDL_WriteU32LE(io, 16) &&
+              SDL_WriteU16LE(io, 1) && SDL_WriteU16LE(io, static_cast<Uint16>(channels)) &&
+              SDL_WriteU32LE(io, rate) && SDL_WriteU32LE(io, rate * channels * 2) &&
+              SDL_WriteU16LE(io, static_cast<Uint16>(channels * 2)) && SDL_WriteU16LE(io, 16) &&
+              SDL_WriteIO(io, "data", 4) == 4 && SDL_WriteU32LE(io, dataSize);
+
+    std::vector<Sint16> samples(frames * channels);
+    for (Uint32 i = 0; i < frames; i++) {
+        Sint16 value = static_cast<Sint16>(8000.0f * std::sin(6.2831853f * hz * i / rate));
+        for (int c = 0; c < channels; c++) {
+            samples[i * channels + c] = value;
+        }
+    }
+    ok = ok && SDL_WriteIO(io, samples.data(), dataSize) == dataSize;
+    return SDL_CloseIO(io) && ok;
+}
+
+// Burns CPU rather than sleeping so the stall competes with the worker like real work
+void Stall(int ms) {
+    auto end = Clock::now() + std::chrono::milliseconds(ms);
+    volatile double sink = 0.0;
+    while (Clock::now() < end) {
+        for (int i = 0; i < 1000; i++) {
+            sink = sink + std::sqrt(static_cast<double>(i));
+        }
+    }
+}
+} // namespace
+
+int main() {
+    SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+    if (!SDL_Init(SDL_INIT_AUDIO)) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    // Source rates differ from the mixer's so the converters do real work
+    auto dir = std::filesystem::temp_directory_path();
+    std::string musicPath = (dir / "vne_bench_music.wav").string();
+    std::string voicePath = (dir / "vne_bench_voice.wav").string();
+    if (!WriteTone(musicPath, 44100, 2, 3.0f, 220.0f) ||
+        !WriteTone(voicePath, 22050, 1, 1.5f, 440.0f)) {
+        std::cerr << "Failed to write test clips: " << SDL_GetError() << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+
+    int voices = 0;
+    int stalls = 0;
+    uint64_t underruns = 0;
+    {
+        AudioSystem audio;
+        if (!audio.Initialize()) {
+            SDL_Quit();
+            return 1;
+        }
+        audio.PlayMusic(musicPath);
+
+        auto start = Clock::now();
+        auto nextVoice = start;
+        while (Clock::now() - start < std::chrono::seconds(runSeconds)) {
+            if (Clock::now() >= nextVoice) {
+                audio.PlayVoice(voicePath);
+                nextVoice += std::chrono::milliseconds(voiceIntervalMs);
+                voices++;
+            }
+            Stall(stallMs[stalls++ % (sizeof(stallMs) / sizeof(stallMs[0]))]);
+        }
+        underruns = audio.GetUnderrunCount();
+    }
+
+    std::filesystem::remove(musicPath);
+    std::filesystem::remove(voicePath);
+    SDL_Quit();
+
+    std::cout << "AudioBench: " << runSeconds << " s, " << voices << " voice restarts, " << stalls
+              << " main-thread stalls (up to 300 ms), " << underruns << " underruns" << std::endl;
+    return underruns == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "ReadState.h"
+#include "ScriptCompiler.h"
+#include "ScriptVM.h"
+#include "SkipMode.h"
+
+// Skips a long, fully read route the same way Game does: frame-sized time slices
+// through SkipMode, with background and part changes batched along the way.
+namespace {
+const int lineCount = 5000;
+
+std::string BuildScript() {
+    std::string script = "set affection 0\n";
+    for (int i = 0; i < lineCount; i++) {
+        script += "say \"Speaker\" \"Line number " + std::to_string(i) + " of the common route.\"\n";
+        script += "add affection 1\n";
+        if (i % 50 == 0) {
+            script += "bg \"assets/backgrounds/scene" + std::to_string(i / 50) + ".png\"\n";
+            script += "part hair \"assets/sprites/hair.png\" 0 0 256 256\n";
+        }
+    }
+    script += "say \"Speaker\" \"This line has not been read yet.\"\n";
+    return script;
+}
+} // namespace
+
+int main() {
+    ScriptCompiler compiler;
+    ScriptProgram program;
+    if (!compiler.Compile(BuildScript(), program)) {
+        std::cerr << "Compile failed: " << compiler.GetError() << std::endl;
+        return 1;
+    }
+
+    ScriptVM vm;
+    if (!vm.Load(std::move(program))) {
+        return 1;
+    }
+
+    ReadState readState;
+    readState.Bind(vm.GetProgram());
+    for (int i = 0; i < lineCount; i++) {
+        readState.MarkRead(i);
+    }
+
+    SkipMode skipMode;
+    skipMode.Start();
+    int slices = 0;
+    SkipResult result = SkipResult::Budget;
+    while (result == SkipResult::Budget) {
+        auto deadline = SkipMode::Clock::now() + std::chrono::milliseconds(8);
+        result = skipMode.Advance(vm, readState, deadline);
+        slices++;
+    }
+    skipMode.Stop();
+
+    if (result != SkipResult::UnreadText) {
+        std::cerr << "Skip stopped for the wrong reason" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Skipped " << skipMode.GetSkippedNodes() << " read lines in "
+              << skipMode.GetElapsedSeconds() * 1000.0 << " ms over " << slices << " slice(s)"
+              << std::endl;
+    std::cout << "Throughput: " << static_cast<uint64_t>(skipMode.GetNodesPerSecond())
+              << " lines/s" << std::endl;
+    std::cout << "Stopped at unread node " << vm.GetCommand().c << std::endl;
+    return 0;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RingBuffer.h"
+#include "SDLWrappers.h"
+
+enum class AudioChannel {
+    MUSIC,
+    VOICE,
+    COUNT
+};
+
+// Incremental RIFF/WAVE reader. Reads the file a chunk at a time and converts
+// it to the mixer's format through an SDL_AudioStream, so memory use does not
+// depend on clip length. Accepts 8/16/32-bit PCM and 32-bit float.
+class WavStream {
+private:
+    SDLIOStreamPtr file;
+    SDLAudioStreamPtr converter;
+    Sint64 dataStart;
+    Uint64 dataSize;
+    Uint64 dataRead;
+    Uint16 blockAlign;  // Bytes per sample frame; the converter only takes whole frames
+    bool flushed;
+    std::vector<Uint8> readBuffer;
+
+public:
+    WavStream();
+
+    bool Open(const std::string& path, const SDL_AudioSpec& outputSpec);
+    bool Rewind();
+
+    // Fills `out` with up to `maxSamples` converted samples; 0 means end of clip or
+    // a decode error, after which the stream stays closed
+    size_t Read(float* out, size_t maxSamples);
+};
+
+// Streams music and voice from a worker thread into per-channel lock-free rings
+// that the device callback mixes. The callback never blocks or allocates, and
+// each ring holds enough decoded audio to ride out long main-thread stalls such
+// as texture uploads. Run with SDL_AUDIO_DRIVER=dummy (or disk) to exercise it
+// without sound hardware.
+class AudioSystem {
+public:
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int CHANNELS = 2;
+
+private:
+    struct Channel {
+        SpscRingBuffer<float> ring;
+        std::atomic<float> volume;
+        std::atomic<bool> flushPending;  // set by the worker, cleared by the callback
+        std::atomic<bool> streaming;     // decoder still has data to deliver
+        float gain;                      // callback-only, ramps towards the target gain
+
+        // Worker-only state
+        std::unique_ptr<WavStream> decoder;
+        std::string pendingPath;
+        bool loop;
+
+        explicit Channel(size_t ringSamples);
+    };
+
+    struct Command {
+        AudioChannel channel;
+        std::string path;  // empty stops the channel
+        bool loop;
+    };
+
+    SDLAudioStreamPtr deviceStream;
+    SDL_AudioSpec spec;
+    std::array<std::unique_ptr<Channel>, static_cast<size_t>(AudioChannel::COUNT)> channels;
+
+    std::vector<float> mixBuffer;
+    std::vector<float> channelBuffer;
+    std::atomic<float> duckLevel;
+    std::atomic<uint64_t> underruns;
+
+    std::thread worker;
+    std::mutex commandMutex;
+    std::condition_variable commandSignal;
+    std::deque<Command> commands;
+    bool running;
+
+    Channel& GetChannel(AudioChannel channel) {
+        return *channels[static_cast<size_t>(channel)];
+    }
+
+    void Post(AudioChannel channel, const std::string& path, bool loop);
+    void WorkerLoop();
+    void ApplyCommand(const Command& command);
+    bool FillChannel(Channel& channel, std::vector<float>& decodeBuffer);
+
+    static void SDLCALL MixCallback(void* userdata, SDL_AudioStream* stream,
+                                    int additionalAmount, int totalAmount);
+    void Mix(SDL_AudioStream* stream, int bytes);
+
+public:
+    AudioSystem();
+    ~AudioSystem();
+
+    AudioSystem(const AudioSystem&) = delete;
+    AudioSystem& operator=(const AudioSystem&) = delete;
+
+    bool Initialize();
+    void Shutdown();
+    bool IsInitialized() const { return deviceStream != nullptr; }
+
+    void PlayMusic(const std::string& path, bool loop = true);
+    void StopMusic();
+    void PlayVoice(const std::string& path);
+    void StopVoice();
+
+    void SetVolume(AudioChannel channel, float volume);
+    // Music gain multiplier while a voice line is playing
+    void SetDuckLevel(float level) { duckLevel.store(level); }
+
+    bool IsVoicePlaying();
+    uint64_t GetUnderrunCount() const { return underruns.load(); }
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RingBuffer.h"
+#include "SDLWrappers.h"
+
+// Plays a directory of numbered frames (frame_0001.png, ...) as a looping background.
+// A worker thread decodes a few frames ahead into a fixed ring of surfaces; the main
+// thread uploads the frame due on the display clock into one of two streaming
+// textures with SDL_UpdateTexture. Memory stays at SLOT_COUNT surfaces plus two
+// textures, however long the clip is.
+class BackgroundPlayer {
+public:
+    static constexpr size_t SLOT_COUNT = 4;
+
+private:
+    struct Slot {
+        SDLSurfacePtr surface;  // Fixed size and format, reused for every frame
+        uint64_t frame;         // Sequence number, counting up across loops
+    };
+
+    SDL_Renderer* renderer;
+    std::array<SDLTexturePtr, 2> textures;
+    size_t shownTexture;
+    bool hasFrame;
+
+    std::vector<std::string> framePaths;
+    std::array<Slot, SLOT_COUNT> slots;
+    SpscRingBuffer<size_t> decoded;  // worker -> main: slots holding a frame
+    SpscRingBuffer<size_t> released; // main -> worker: slots free to decode into
+
+    Uint64 startNs;
+    Uint64 frameNs;
+    uint64_t shownFrame;
+    uint64_t droppedFrames;
+    std::atomic<uint64_t> clockFrame;  // Frame the display clock has reached; read by the worker
+
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wakeSignal;
+    std::atomic<bool> running;
+
+    bool DecodeInto(const std::string& path, SDL_Surface* target) const;
+    void WorkerLoop();
+
+public:
+    explicit BackgroundPlayer(SDL_Renderer* renderer);
+    ~BackgroundPlayer();
+
+    BackgroundPlayer(const BackgroundPlayer&) = delete;
+    BackgroundPlayer& operator=(const BackgroundPlayer&) = delete;
+
+    // Starts looping the image files in `directory` (sorted by name) at `fps`.
+    // `scale` shrinks frames on decode, e.g. ResourceManager's asset tier. If the
+    // directory has no readable frames, whatever was playing keeps playing.
+    bool Open(const std::string& directory, int fps, float scale = 1.0f);
+    void Close();
+    bool IsPlaying() const { return hasFrame; }
+
+    // Shows the newest decoded frame that is due at `nowNs`, dropping any that are late
+    void Update(Uint64 nowNs);
+    SDL_Texture* GetTexture() const { return hasFrame ? textures[shownTexture].get() : nullptr; }
+
+    uint64_t GetDroppedFrames() const { return droppedFrames; }
+};
@@ -16,10 +16,11 @@ enum class CharacterLayer {
 
 struct CharacterPart {
     std::shared_ptr<SDL_Texture> texture;
-    SDL_Rect sourceRect;
+    SDL_Rect sourceRect;    // In 1x sprite-sheet pixels, whatever tier the texture is
+    float textureScale;     // Texture pixels per 1x pixel
     SDL_Color tintColor;
     
-    CharacterPart() : texture(nullptr), tintColor{255, 255, 255, 255} {
+    CharacterPart() : texture(nullptr), textureScale(1.0f), tintColor{255, 255, 255, 255} {
         sourceRect = {0, 0, 0, 0};
     }
 };
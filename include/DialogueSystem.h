@@ -1,40 +1,79 @@
 #pragma once
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <queue>
 #include <memory>
+#include "Localization.h"
 #include "SDLWrappers.h"
 
 struct DialogueChoice {
     std::string text;
-    int nextDialogueId;
+    int nextDialogueId;  // Handed to the choice handler; for scripted menus, a bytecode address
+    int textId = -1;     // String table id; takes precedence over `text` when set
 };
 
 struct DialogueNode {
+    int id;  // Script node id, -1 for menus and unscripted lines
     std::string speaker;
     std::string text;
+    int speakerId;  // String table ids; take precedence over speaker/text when set
+    int textId;
     std::vector<DialogueChoice> choices;
     bool hasChoices;
+    std::string voice;  // Clip started alongside the typewriter, empty for none
     
-    DialogueNode() : hasChoices(false) {}
+    DialogueNode() : id(-1), speakerId(-1), textId(-1), hasChoices(false) {}
+};
+
+// Fonts for one locale: fonts[0] renders, the rest fill in glyphs it lacks
+struct FontChain {
+    std::vector<TTFFontPtr> fonts;
+
+    FontChain() = default;
+    FontChain(FontChain&&) = default;
+    ~FontChain() {
+        if (!fonts.empty() && fonts[0]) {
+            TTF_ClearFallbackFonts(fonts[0].get());
+        }
+    }
+
+    TTF_Font* GetPrimary() const { return fonts.empty() ? nullptr : fonts[0].get(); }
+};
+
+// A rendered string kept until its text, the locale or the font changes
+struct TextLayout {
+    SDLTexturePtr texture;
+    float w = 0.0f;
+    float h = 0.0f;
 };
 
 class DialogueSystem {
 private:
-    TTFFontPtr font;
+    std::vector<FontChain> fontChains;  // One per locale
+    TTF_Font* font;
     SDLTexturePtr textboxTexture;
     SDL_Renderer* renderer;
+
+    const Localization* localization;
+    uint32_t localeRevision;
     
     std::queue<DialogueNode> dialogueQueue;
     DialogueNode currentDialogue;
     
     // Text rendering
-    std::string displayedText;
     float typewriterSpeed;
     float typewriterTime;
-    size_t currentCharIndex;
+    size_t currentCharIndex;  // Byte offset into the current text, on a UTF-8 boundary
+
+    TextLayout speakerLayout;
+    TextLayout textLayout;
+    std::vector<TextLayout> choiceLayouts;
+    size_t textLayoutChars;
+    bool layoutsDirty;
     
     // UI positions
     SDL_Rect textboxRect;
@@ -44,20 +83,45 @@ private:
     bool isActive;
     bool isTyping;
     
+    std::function<void(int)> choiceHandler;
+    std::function<void(const DialogueNode&)> lineStartHandler;
+
+    std::string_view GetSpeaker() const;
+    std::string_view GetText() const;
+    std::string_view GetChoiceText(const DialogueChoice& choice) const;
+
+    void SyncLocale();
+    void RebuildLayouts();
+    TextLayout MakeLayout(std::string_view text, SDL_Color color, int wrapWidth) const;
+
 public:
     DialogueSystem(SDL_Renderer* renderer);
     ~DialogueSystem();
     
-    bool Initialize();
+    // Loads a font chain per locale (its fonts, then the built-in defaults);
+    // without a Localization only the defaults are used
+    bool Initialize(const Localization* localization = nullptr);
+    // Same, with chains already loaded by LoadFontChains() (e.g. on another thread)
+    bool Initialize(const Localization* localization, std::vector<FontChain> chains);
     void AddDialogue(const DialogueNode& dialogue);
     void StartDialogue();
     void NextDialogue();
     void SelectChoice(int choiceIndex);
+    void SetChoiceHandler(std::function<void(int)> handler) { choiceHandler = std::move(handler); }
+    // Called as each node starts typing, e.g. to cue its voice line in sync
+    void SetLineStartHandler(std::function<void(const DialogueNode&)> handler) {
+        lineStartHandler = std::move(handler);
+    }
     
     void Update(float deltaTime);
     void Render();
     
     bool IsActive() const { return isActive; }
+    bool IsTyping() const { return isTyping; }
     bool HasChoices() const { return currentDialogue.hasChoices; }
     const std::vector<DialogueChoice>& GetChoices() const { return currentDialogue.choices; }
-};
\ No newline at end of file
+
+    static FontChain LoadFontChain(const std::vector<std::string>& paths, int ptsize);
+    // Needs no renderer, so it can run while the window is still being created
+    static std::vector<FontChain> LoadFontChains(const Localization* localization);
+};
@@ -2,15 +2,28 @@
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
 #include <SDL3_ttf/SDL_ttf.h>
+#include <chrono>
 #include <memory>
 #include <string>
+#include "AudioSystem.h"
+#include "BackgroundPlayer.h"
 #include "Character.h"
 #include "DialogueSystem.h"
+#include "Localization.h"
+#include "ParticleSystem.h"
+#include "ReadState.h"
 #include "ResourceManager.h"
+#include "ScriptVM.h"
 #include "SDLWrappers.h"
 #include "SDLManager.h"
+#include "SkipMode.h"
 
 class Game {
+public:
+    // Layout coordinates; the renderer letterboxes them onto any window size
+    static constexpr int LOGICAL_WIDTH = 1280;
+    static constexpr int LOGICAL_HEIGHT = 720;
+    
 private:
     SDLManager sdlManager;
     SDLWindowPtr window;
@@ -22,8 +35,42 @@ private:
     
     std::unique_ptr<Character> playerCharacter;
     std::unique_ptr<DialogueSystem> dialogueSystem;
+    std::unique_ptr<Localization> localization;
+    std::unique_ptr<ScriptVM> scriptVM;
+    std::unique_ptr<AudioSystem> audio;
+    ParticleSystem particles;
+    
+    ReadState readState;
+    SkipMode skipMode;
+    int currentNodeId;
+    std::string pendingVoice;  // VOICE cue waiting for its SAY
+    Uint64 lastRenderTicks;
+    
+    // Time-to-first-frame is measured from Initialize()
+    std::chrono::steady_clock::time_point startupTime;
+    bool firstFramePresented;
     
     std::shared_ptr<SDL_Texture> backgroundTexture;
+    std::unique_ptr<BackgroundPlayer> backgroundPlayer;  // Animated backgrounds
+    
+    bool LoadScript(const std::string& path);
+    void AdvanceScript();
+    void ResolveText(int32_t operand, std::string& text, int& textId) const;
+    void ShowLine(const Instruction& say);
+    void ShowChoices();
+    void ApplyBackground(const Instruction& background);
+    void ApplyPart(const Instruction& part);
+    void ApplyMusic(int32_t path);
+    void ApplyParticles(int32_t preset);
+    void OnLineStart(const DialogueNode& node);
+    
+    void StartSkip();
+    void StopSkip();
+    void UpdateSkip();
+    void FlushSkipBatch();
+    
+    void CycleLocale();
+    void UpdateAssetTier();
     
 public:
     Game();
@@ -0,0 +1,46 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "StringTable.h"
+
+// Per-locale string tables plus the fonts each locale prefers. Every table stays
+// mapped, so switching locale is a single index change; consumers compare
+// GetRevision() against their cached value to know when to re-layout text.
+class Localization {
+private:
+    struct Locale {
+        std::string code;
+        std::unique_ptr<StringTable> table;
+        std::vector<std::string> fontPaths;
+    };
+
+    std::vector<Locale> locales;
+    size_t active;
+    uint32_t revision;
+
+public:
+    Localization();
+
+    // Reads "<code> <strings.txt> [font paths...]" lines. Each source is compiled
+    // to a sibling .vnst when that is missing or older than the source.
+    bool LoadManifest(const std::string& path);
+    bool AddLocale(const std::string& code, const std::string& tablePath,
+                   const std::vector<std::string>& fontPaths);
+
+    bool SetLocale(size_t index);
+    bool SetLocale(const std::string& code);
+
+    // Looks in the active locale first, then the first locale, so untranslated
+    // lines fall back instead of disappearing
+    std::string_view Get(int id) const;
+
+    size_t GetLocaleCount() const { return locales.size(); }
+    size_t GetActiveLocale() const { return active; }
+    const std::string& GetLocaleCode(size_t index) const { return locales[index].code; }
+    const std::vector<std::string>& GetFontPaths(size_t index) const {
+        return locales[index].fontPaths;
+    }
+    uint32_t GetRevision() const { return revision; }
+};
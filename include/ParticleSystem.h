@@ -0,0 +1,110 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class ParticlePreset {
+    RAIN,
+    SNOW,
+    PETALS,
+    SPARKLES,
+    COUNT
+};
+
+struct ParticleEmitterConfig {
+    SDL_FRect spawnArea;  // New particles appear uniformly inside this rect
+    float spawnRate;      // Particles per second
+    float lifetimeMin, lifetimeMax;
+    float velocityXMin, velocityXMax;
+    float velocityYMin, velocityYMax;
+    float gravity;        // Downward acceleration, px/s^2
+    float wind;           // Constant sideways acceleration, px/s^2
+    float swayAmplitude;  // Extra sideways acceleration oscillating over time, px/s^2
+    float swayFrequency;  // Hz
+    float sizeMin, sizeMax;
+    float aspect;         // Quad height / width; rain streaks are tall and thin
+    float endScale;       // Size multiplier reached at the end of a particle's life
+    SDL_FColor startColor, endColor;
+    SDL_BlendMode blendMode;
+    size_t capacity;      // Particles alive at once; spawning stops at the cap
+
+    // Tuned for a `width` x `height` logical screen
+    static ParticleEmitterConfig FromPreset(ParticlePreset preset, float width, float height);
+};
+
+// A fixed-capacity pool of particles stored as parallel arrays, so the update loops
+// are straight-line float math the compiler can vectorize. Nothing is allocated
+// after Reset(); dead particles are swapped out with the last live one.
+class ParticleEmitter {
+private:
+    ParticleEmitterConfig config;
+    std::shared_ptr<SDL_Texture> texture;
+
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;
+    std::vector<float> age, invLifetime;  // age runs from 0 to 1 over the particle's life
+    std::vector<float> size;
+    size_t count;
+
+    // Four vertices and six indices per particle; the index pattern never changes
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+    float spawnAccumulator;
+    float time;
+    bool emitting;
+    uint32_t rngState;
+
+    float Random01();
+    float RandomRange(float min, float max) { return min + (max - min) * Random01(); }
+    void Spawn(size_t spawnCount);
+    void Integrate(float deltaTime);
+    void RemoveDead();
+
+public:
+    ParticleEmitter();
+
+    // Reconfigures the emitter; storage only grows when the new capacity is larger
+    void Reset(const ParticleEmitterConfig& config);
+    void SetTexture(std::shared_ptr<SDL_Texture> texture) { this->texture = std::move(texture); }
+
+    // Spawns, moves and ages particles; the particle loop never allocates
+    void Update(float deltaTime);
+    // Writes one quad per live particle into the vertex buffer
+    void BuildGeometry();
+    // Draws everything with a single SDL_RenderGeometry call
+    void Render(SDL_Renderer* renderer);
+
+    // Stops spawning; live particles finish their lifetimes
+    void Stop() { emitting = false; }
+    bool IsEmitting() const { return emitting; }
+    bool IsFinished() const { return !emitting && count == 0; }
+    size_t GetCount() const { return count; }
+    // The configured cap; storage kept from an earlier, larger preset may exceed it
+    size_t GetCapacity() const { return config.capacity; }
+    size_t GetStorageSize() const { return posX.size(); }
+};
+
+// Owns a pool of emitters. Stopped emitters drain, then go back to the pool for the
+// next Start(), so switching effects does not reallocate particle storage.
+class ParticleSystem {
+private:
+    std::vector<std::unique_ptr<ParticleEmitter>> active;
+    std::vector<std::unique_ptr<ParticleEmitter>> pool;
+
+    // Pooled emitters keep their arrays but not their texture, so no texture outlives
+    // the renderer just because the pool does
+    void Release(std::unique_ptr<ParticleEmitter> emitter);
+
+public:
+    ParticleEmitter* Start(const ParticleEmitterConfig& config);
+    ParticleEmitter* Start(ParticlePreset preset, float width, float height);
+    void StopAll();
+    void Clear();
+
+    void Update(float deltaTime);
+    void Render(SDL_Renderer* renderer);
+
+    size_t GetParticleCount() const;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ScriptVM.h"
+
+// One bit per dialogue node id, persisted between sessions so skip mode
+// knows which lines the player has already seen.
+class ReadState {
+private:
+    std::vector<uint64_t> words;
+    size_t nodeCount;
+    uint64_t fingerprint;
+    bool dirty;
+
+public:
+    ReadState();
+
+    // Sizes the bitset for `program`; clears it if the script's lines changed
+    void Bind(const ScriptProgram& program);
+
+    bool IsRead(int nodeId) const {
+        if (nodeId < 0 || static_cast<size_t>(nodeId) >= nodeCount) {
+            return false;
+        }
+        return (words[nodeId >> 6] >> (nodeId & 63)) & 1u;
+    }
+
+    void MarkRead(int nodeId) {
+        if (nodeId < 0 || static_cast<size_t>(nodeId) >= nodeCount) {
+            return;
+        }
+        uint64_t bit = uint64_t(1) << (nodeId & 63);
+        if (!(words[nodeId >> 6] & bit)) {
+            words[nodeId >> 6] |= bit;
+            dirty = true;
+        }
+    }
+
+    size_t CountRead() const;
+    size_t GetNodeCount() const { return nodeCount; }
+
+    // A file written for a different version of the script is ignored
+    bool Load(const std::string& path);
+    bool Save(const std::string& path);
+    bool IsDirty() const { return dirty; }
+
+    static uint64_t Fingerprint(const ScriptProgram& program);
+};
@@ -6,18 +6,26 @@
 #include <memory>
 #include "SDLWrappers.h"
 
+// Float texture property: texture pixels per logical pixel (0.5 for a half-size tier)
+#define VNE_PROP_TEXTURE_TIER_SCALE_FLOAT "vne.texture.tier_scale"
+
+// Asset tiers are picked for the output size: a texture for `path` loads from
+// `name@0.5x.png` / `name@2x.png` when that file exists, otherwise the 1x file is
+// downscaled once at load for the 0.5x tier (1x files are never upscaled).
+// Callers keep working in 1x logical coordinates; see GetTextureScale().
 class ResourceManager {
 private:
     static std::unique_ptr<ResourceManager> instance;
     std::map<std::string, std::shared_ptr<SDL_Texture>> textures;
     SDL_Renderer* renderer;
+    float tierScale;
     
-    ResourceManager() : renderer(nullptr) {}
+    ResourceManager() : renderer(nullptr), tierScale(1.0f) {}
     
 public:
     // Allow make_unique to access constructor
     struct PrivateTag {};
-    ResourceManager(PrivateTag) : renderer(nullptr) {}
+    ResourceManager(PrivateTag) : renderer(nullptr), tierScale(1.0f) {}
     ~ResourceManager() { UnloadAll(); }
     
     static ResourceManager& GetInstance();
@@ -25,6 +33,20 @@ public:
     static void Shutdown();
     
     void SetRenderer(SDL_Renderer* renderer);
+    
+    // Decodes `path` at the current tier without touching the renderer, so it may run
+    // on any thread; `scale` receives the tier scale. AddTexture() uploads and caches it.
+    SDLSurfacePtr DecodeImage(const std::string& path, float& scale) const;
+    std::shared_ptr<SDL_Texture> AddTexture(const std::string& path, SDL_Surface* surface,
+                                            float scale);
+    
+    // Picks the smallest tier that covers `outputScale` (output pixels per logical
+    // pixel). Returns true if the tier changed; the cache is then dropped so later
+    // loads use the new tier, while textures already handed out stay valid.
+    bool SetOutputScale(float outputScale);
+    float GetTierScale() const { return tierScale; }
+    static float GetTextureScale(SDL_Texture* texture);
+    
     std::shared_ptr<SDL_Texture> LoadTexture(const std::string& path);
     std::shared_ptr<SDL_Texture> GetTexture(const std::string& path);
     void UnloadTexture(const std::string& path);
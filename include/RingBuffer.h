@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Lock-free single-producer/single-consumer ring. Storage is allocated once up
+// front; Write() belongs to one thread and Read()/Discard() to another.
+template <typename T>
+class SpscRingBuffer {
+private:
+    std::unique_ptr<T[]> buffer;
+    size_t capacity;
+    size_t mask;
+
+    // Free-running indices; kept on separate cache lines so the two sides don't
+    // invalidate each other on every update
+    alignas(64) std::atomic<size_t> head;  // written by the producer
+    alignas(64) std::atomic<size_t> tail;  // written by the consumer
+
+public:
+    // `minCapacity` is rounded up to a power of two
+    explicit SpscRingBuffer(size_t minCapacity) : capacity(1), head(0), tail(0) {
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        mask = capacity - 1;
+        buffer = std::make_unique<T[]>(capacity);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    size_t GetCapacity() const { return capacity; }
+
+    size_t Available() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t Free() const { return capacity - Available(); }
+
+    // Producer side: copies as much of `data` as fits and returns the count written
+    size_t Write(const T* data, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        count = std::min(count, capacity - (h - t));
+
+        size_t start = h & mask;
+        size_t first = std::min(count, capacity - start);
+        std::copy(data, data + first, buffer.get() + start);
+        std::copy(data + first, data + count, buffer.get());
+
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: copies up to `count` items out and returns the count read
+    size_t Read(T* out, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        count = std::min(count, h - t);
+
+        size_t start = t & mask;
+        size_t first = std::min(count, capacity - start);
+        std::copy(buffer.get() + start, buffer.get() + start + first, out);
+        std::copy(buffer.get(), buffer.get() + (count - first), out + first);
+
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: the oldest queued item without removing it, or nullptr if empty
+    const T* Peek() const {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return nullptr;
+        }
+        return &buffer[t & mask];
+    }
+
+    // Consumer side: drops everything currently queued
+    void Discard() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+};
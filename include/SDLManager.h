@@ -5,6 +5,7 @@
 class SDLManager {
 private:
     bool initialized = false;
+    bool audioAvailable = false;
     
 public:
     SDLManager() = default;
@@ -30,6 +31,9 @@ public:
             return false;
         }
         
+        // The game still runs silently without an audio device
+        audioAvailable = SDL_InitSubSystem(SDL_INIT_AUDIO);
+        
         initialized = true;
         return true;
     }
@@ -39,8 +43,10 @@ public:
             TTF_Quit();
             SDL_Quit();
             initialized = false;
+            audioAvailable = false;
         }
     }
     
     bool isInitialized() const { return initialized; }
+    bool isAudioAvailable() const { return audioAvailable; }
 };
\ No newline at end of file
@@ -29,6 +29,18 @@ struct SDLSurfaceDeleter {
     }
 };
 
+struct SDLAudioStreamDeleter {
+    void operator()(SDL_AudioStream* stream) const {
+        if (stream) SDL_DestroyAudioStream(stream);
+    }
+};
+
+struct SDLIOStreamDeleter {
+    void operator()(SDL_IOStream* io) const {
+        if (io) SDL_CloseIO(io);
+    }
+};
+
 struct TTFFontDeleter {
     void operator()(TTF_Font* font) const {
         if (font) TTF_CloseFont(font);
@@ -40,6 +52,8 @@ using SDLWindowPtr = std::unique_ptr<SDL_Window, SDLWindowDeleter>;
 using SDLRendererPtr = std::unique_ptr<SDL_Renderer, SDLRendererDeleter>;
 using SDLTexturePtr = std::unique_ptr<SDL_Texture, SDLTextureDeleter>;
 using SDLSurfacePtr = std::unique_ptr<SDL_Surface, SDLSurfaceDeleter>;
+using SDLAudioStreamPtr = std::unique_ptr<SDL_AudioStream, SDLAudioStreamDeleter>;
+using SDLIOStreamPtr = std::unique_ptr<SDL_IOStream, SDLIOStreamDeleter>;
 using TTFFontPtr = std::unique_ptr<TTF_Font, TTFFontDeleter>;
 
 // Helper factory functions
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ScriptVM.h"
+
+// Compiles the line-based story script into ScriptVM bytecode.
+//
+//   label NAME                     goto NAME
+//   set VAR INT|VAR                add VAR INT|VAR            sub VAR INT
+//   flag NAME                      unflag NAME
+//   if [not] FLAG goto NAME        if VAR (== != < <= > >=) INT|VAR goto NAME
+//   say [SPEAKER] TEXT             bg "PATH"
+//   part LAYER "PATH" X Y W H      (LAYER: base, hair, eyes, outfit, accessory)
+//   choice TEXT NAME               menu
+//   bganim "DIRECTORY" FPS         looping background from numbered frames
+//   voice "PATH"                   music "PATH" | music stop
+//   particles rain|snow|petals|sparkles|off
+//   end
+//
+// SPEAKER and TEXT are either a "quoted literal" or @ID, an entry in the
+// active locale's string table.
+//
+// '#' starts a comment outside of quotes. Every `say` becomes a dialogue node whose
+// id is its position among the script's `say` lines. A `voice` cue belongs to the
+// next `say` and starts with its typewriter. Variables are 32-bit and `add`/`sub`
+// wrap around on overflow. A `menu` offers the `choice` lines
+// directly before it: at least one and at most ScriptVM::MAX_CHOICES.
+class ScriptCompiler {
+private:
+    struct Fixup {
+        size_t instruction;
+        int32_t Instruction::*field;
+        std::string label;
+        int line;
+    };
+
+    ScriptProgram program;
+    std::unordered_map<std::string, int32_t> labels;
+    std::unordered_map<std::string, int32_t> variables;
+    std::unordered_map<std::string, int32_t> flags;
+    std::unordered_map<std::string, int32_t> strings;
+    std::vector<Fixup> fixups;
+    std::string error;
+    int line;
+    size_t pendingChoices;  // `choice` lines waiting for their `menu`
+
+    bool Fail(const std::string& message);
+    bool Tokenize(const std::string& text, std::vector<std::string>& tokens);
+    bool CheckNoPendingChoices(const std::string& where);
+    bool CompileStatement(const std::vector<std::string>& tokens);
+    bool ResolveLabels();
+
+    int32_t Variable(const std::string& name);
+    int32_t Flag(const std::string& name);
+    int32_t String(const std::string& token);
+    bool Text(const std::string& token, int32_t& id);
+    void Emit(OpCode op, int32_t a = 0, int32_t b = 0, int32_t c = 0);
+    void EmitJump(OpCode op, int32_t a, int32_t b, int32_t Instruction::*field,
+                  const std::string& label);
+
+public:
+    ScriptCompiler();
+
+    bool Compile(const std::string& source, ScriptProgram& out);
+    bool CompileFile(const std::string& path, ScriptProgram& out);
+
+    const std::string& GetError() const { return error; }
+};
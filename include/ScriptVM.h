@@ -0,0 +1,171 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bytecode opcodes. Operand meaning per opcode:
+//   SET/ADD            a = variable, b = immediate
+//   SET_VAR/ADD_VAR    a = variable, b = source variable
+//   FLAG_SET/CLEAR     a = flag
+//   JMP                a = target
+//   JMP_FLAG/NOT_FLAG  a = flag, b = target
+//   JMP_<cmp>          a = variable, b = immediate, c = target
+//   JMP_<cmp>_VAR      a = variable, b = variable, c = target
+//   SAY                a = speaker text (-1 for narration), b = text, c = node id
+//   BACKGROUND         a = path string
+//   BACKGROUND_ANIM    a = frame directory string, b = frames per second
+//   SET_PART           a = character layer, b = path string, c = rect index
+//   VOICE              a = path string, played with the next SAY
+//   MUSIC              a = path string, -1 to stop
+//   PARTICLES          a = particle preset, -1 to stop
+//   CHOICE             a = text, b = target
+//   MENU               shows the choices collected since the last MENU
+#define VN_SCRIPT_OPCODES(X)                                                                       \
+    X(NOP)                                                                                         \
+    X(END)                                                                                         \
+    X(SET)                                                                                         \
+    X(SET_VAR)                                                                                     \
+    X(ADD)                                                                                         \
+    X(ADD_VAR)                                                                                     \
+    X(FLAG_SET)                                                                                    \
+    X(FLAG_CLEAR)                                                                                  \
+    X(JMP)                                                                                         \
+    X(JMP_FLAG)                                                                                    \
+    X(JMP_NOT_FLAG)                                                                                \
+    X(JMP_EQ)                                                                                      \
+    X(JMP_NE)                                                                                      \
+    X(JMP_LT)                                                                                      \
+    X(JMP_LE)                                                                                      \
+    X(JMP_GT)                                                                                      \
+    X(JMP_GE)                                                                                      \
+    X(JMP_EQ_VAR)                                                                                  \
+    X(JMP_NE_VAR)                                                                                  \
+    X(JMP_LT_VAR)                                                                                  \
+    X(JMP_LE_VAR)                                                                                  \
+    X(JMP_GT_VAR)                                                                                  \
+    X(JMP_GE_VAR)                                                                                  \
+    X(SAY)                                                                                         \
+    X(BACKGROUND)                                                                                  \
+    X(BACKGROUND_ANIM)                                                                             \
+    X(SET_PART)                                                                                    \
+    X(VOICE)                                                                                       \
+    X(MUSIC)                                                                                       \
+    X(PARTICLES)                                                                                   \
+    X(CHOICE)                                                                                      \
+    X(MENU)
+
+enum class OpCode : uint8_t {
+#define VN_SCRIPT_ENUM(name) name,
+    VN_SCRIPT_OPCODES(VN_SCRIPT_ENUM)
+#undef VN_SCRIPT_ENUM
+    COUNT
+};
+
+struct Instruction {
+    OpCode op;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+};
+
+// Text operands (SAY, CHOICE) with this bit set are ids into the active locale's
+// string table rather than indices into ScriptProgram::strings
+constexpr int32_t SCRIPT_LOCALIZED_STRING = 0x40000000;
+
+inline bool IsLocalizedString(int32_t id) {
+    return id >= 0 && (id & SCRIPT_LOCALIZED_STRING) != 0;
+}
+
+inline int32_t LocalizedStringId(int32_t id) {
+    return id & ~SCRIPT_LOCALIZED_STRING;
+}
+
+// Character layers addressable by SET_PART; indices follow the CharacterLayer enum
+constexpr int32_t SCRIPT_LAYER_COUNT = 5;
+
+// Effects addressable by PARTICLES; indices follow the ParticlePreset enum
+constexpr int32_t SCRIPT_PARTICLE_PRESET_COUNT = 4;
+
+// Frame rate limit for BACKGROUND_ANIM
+constexpr int32_t SCRIPT_MAX_ANIM_FPS = 120;
+
+struct ScriptRect {
+    int x, y, w, h;
+};
+
+struct ScriptProgram {
+    std::vector<Instruction> code;
+    std::vector<std::string> strings;
+    std::vector<ScriptRect> rects;
+    std::vector<std::string> variableNames;
+    std::vector<std::string> flagNames;
+    int nodeCount = 0;
+};
+
+// Why Run() handed control back to the host
+enum class ScriptEvent {
+    ShowText,      // GetCommand() is a SAY; call Run() again once the reader advances
+    SetBackground, // GetCommand() is a BACKGROUND or BACKGROUND_ANIM; call Run() again right away
+    SetPart,       // GetCommand() is a SET_PART; call Run() again right away
+    SetVoice,      // GetCommand() is a VOICE; call Run() again right away
+    SetMusic,      // GetCommand() is a MUSIC; call Run() again right away
+    SetParticles,  // GetCommand() is a PARTICLES; call Run() again right away
+    Choice,        // waiting for Choose()
+    Yield,         // instruction budget used up; call Run() again next frame
+    Finished,
+    Error
+};
+
+struct ScriptChoice {
+    int text;
+    int target;
+};
+
+class ScriptVM {
+public:
+    static constexpr size_t MAX_CHOICES = 8;
+
+private:
+    ScriptProgram program;
+    std::vector<int32_t> variables;
+    std::vector<uint8_t> flags;
+    std::array<ScriptChoice, MAX_CHOICES> choices;
+    size_t choiceCount;
+
+    uint32_t pc;
+    Instruction command;
+    bool loaded;
+    bool finished;
+    bool awaitingChoice;
+    uint64_t executedCount;
+
+    bool Validate(const ScriptProgram& candidate) const;
+
+public:
+    ScriptVM();
+
+    // Takes ownership of a compiled program; fails if any operand is out of range,
+    // which is what lets Run() skip bounds checks
+    bool Load(ScriptProgram compiled);
+    void Reset();
+
+    // Executes until the script needs the host or `budget` instructions have run
+    ScriptEvent Run(uint64_t budget);
+    bool Choose(int target);
+
+    const Instruction& GetCommand() const { return command; }
+    const std::string& GetString(int id) const;
+    const ScriptRect& GetRect(int id) const { return program.rects[id]; }
+    size_t GetChoiceCount() const { return choiceCount; }
+    const ScriptChoice& GetChoice(size_t index) const { return choices[index]; }
+
+    int32_t GetVariable(const std::string& name) const;
+    bool GetFlag(const std::string& name) const;
+
+    const ScriptProgram& GetProgram() const { return program; }
+    uint64_t GetExecutedCount() const { return executedCount; }
+    bool IsFinished() const { return finished; }
+    bool IsAwaitingChoice() const { return awaitingChoice; }
+    bool IsRunnable() const { return loaded && !finished && !awaitingChoice; }
+};
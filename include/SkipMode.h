@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include "ReadState.h"
+#include "ScriptVM.h"
+
+// Visual state changes collected while skipping. Only the latest value of each
+// survives, so a long skip costs one texture lookup per layer instead of one per line.
+struct SkipBatch {
+    Instruction background;                             // latest BACKGROUND(_ANIM), op NOP if none
+    std::array<Instruction, SCRIPT_LAYER_COUNT> parts;  // latest SET_PART per layer
+    uint32_t partMask;                                  // bit per layer in `parts`
+    Instruction lastLine;                               // latest SAY skipped, op NOP if none
+    bool musicChanged;
+    int music;                                          // MUSIC path string, -1 to stop
+    int voice;                                          // VOICE cue for the line not yet reached
+    bool particlesChanged;
+    int particles;                                      // PARTICLES preset, -1 for off
+
+    SkipBatch() { Clear(); }
+    void Clear();
+    bool IsEmpty() const {
+        return background.op == OpCode::NOP && partMask == 0 && lastLine.op == OpCode::NOP &&
+               !musicChanged && voice < 0 && !particlesChanged;
+    }
+};
+
+enum class SkipResult {
+    Budget,     // time slice used up, still skipping
+    UnreadText, // stopped at an unread SAY, left in ScriptVM::GetCommand()
+    Choice,     // stopped at a menu
+    Finished    // script ended or failed
+};
+
+// Runs the script through already-read lines without touching the renderer.
+class SkipMode {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    SkipBatch batch;
+    bool active;
+    uint64_t skippedNodes;
+    Clock::time_point startTime;
+    Clock::time_point stopTime;
+
+public:
+    SkipMode();
+
+    void Start();
+    void Stop();
+    bool IsActive() const { return active; }
+
+    // Advances through read nodes until one is unread, a menu comes up or `deadline` passes
+    SkipResult Advance(ScriptVM& vm, ReadState& readState, Clock::time_point deadline);
+
+    SkipBatch& GetBatch() { return batch; }
+    uint64_t GetSkippedNodes() const { return skippedNodes; }
+    double GetElapsedSeconds() const;
+    double GetNodesPerSecond() const;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only table of UTF-8 strings indexed by id, memory-mapped from a compiled
+// .vnst file so a locale costs no heap beyond what the OS pages in.
+//
+// File layout (little-endian):
+//   char     magic[4] = "VNST"
+//   uint32_t version
+//   uint32_t count
+//   uint32_t offsets[count + 1]  // into the blob; each string is NUL-terminated
+//   char     blob[]
+class StringTable {
+private:
+    const char* data;
+    size_t size;
+    const uint32_t* offsets;
+    const char* blob;
+    uint32_t count;
+
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+    void Unmap();
+
+public:
+    StringTable();
+    ~StringTable();
+
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    bool Open(const std::string& path);
+    void Close() { Unmap(); }
+    bool IsOpen() const { return data != nullptr; }
+
+    // Unknown ids give an empty view; views stay valid until Close()
+    std::string_view Get(int id) const {
+        if (id < 0 || static_cast<uint32_t>(id) >= count) {
+            return {};
+        }
+        uint32_t begin = offsets[id];
+        return std::string_view(blob + begin, offsets[id + 1] - begin - 1);
+    }
+
+    uint32_t GetCount() const { return count; }
+
+    static bool Write(const std::string& path, const std::vector<std::string>& strings);
+
+    // Builds a .vnst from "<id> <text>" lines ('#' comments, \n escapes)
+    static bool Compile(const std::string& sourcePath, const std::string& outputPath);
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One-shot dependency graph of startup work. Worker tasks run on a small thread
+// pool while main-thread tasks (anything that must touch the window or renderer)
+// run on the caller, each as soon as its dependencies finish. A task that fails
+// or throws skips everything that depends on it.
+class TaskGraph {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TaskId = size_t;
+
+    enum class Affinity {
+        Main,
+        Worker
+    };
+
+    enum class TaskState {
+        Pending,
+        Done,
+        Failed,
+        Skipped  // a dependency failed
+    };
+
+private:
+    struct Task {
+        std::string name;
+        Affinity affinity;
+        std::function<bool()> work;
+        std::vector<TaskId> dependents;
+        size_t remainingDeps;
+        bool blocked;  // a dependency failed; never runs
+        TaskState state;
+        double startMs;
+        double endMs;
+    };
+
+    std::vector<Task> tasks;
+    Clock::time_point runStart;
+    double wallMs;
+
+    std::mutex mutex;
+    std::condition_variable readySignal;
+    std::deque<TaskId> readyMain;
+    std::deque<TaskId> readyWorker;
+    size_t unfinished;
+    bool aborted;  // Run() is bailing out; workers stop taking tasks
+
+    double Now() const;
+    void Execute(TaskId id);
+    void Finish(TaskId id, TaskState state);  // caller holds `mutex`
+    void WorkerLoop();
+    void MainLoop(bool runWorkerTasks);
+
+public:
+    TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // Dependencies must already be in the graph, which keeps it acyclic
+    TaskId Add(const std::string& name, Affinity affinity, std::function<bool()> work,
+               const std::vector<TaskId>& dependencies = {});
+
+    // Runs every task and returns once all have finished or been skipped.
+    // Returns true if every task succeeded. Call once.
+    bool Run(size_t maxWorkers = 0);
+
+    TaskState GetState(TaskId id) const { return tasks[id].state; }
+    double GetWallMilliseconds() const { return wallMs; }
+
+    // One line per task: thread, start/end offsets from Run() and duration
+    void PrintTimings(std::ostream& out) const;
+};
@@ -0,0 +1,390 @@
+#include "AudioSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+// About 1.4 s of stereo audio per channel (rounded up to a power of two); the
+// worker has that long to come back before the device would run dry
+const size_t ringSamples = AudioSystem::SAMPLE_RATE * AudioSystem::CHANNELS;
+
+// Decoded per worker iteration, and the largest block the callback mixes at once
+const size_t decodeChunkSamples = 2048 * AudioSystem::CHANNELS;
+const size_t mixBlockSamples = 1024 * AudioSystem::CHANNELS;
+
+// Idle wait between top-ups when every ring is full
+const auto workerIdle = std::chrono::milliseconds(5);
+
+// Gains move at most this much per frame: a full swing takes about 100 ms
+const float gainStep = 1.0f / (0.1f * AudioSystem::SAMPLE_RATE);
+
+const size_t fileChunkBytes = 16 * 1024;
+
+bool ReadTag(SDL_IOStream* io, char tag[4]) {
+    return SDL_ReadIO(io, tag, 4) == 4;
+}
+} // namespace
+
+WavStream::WavStream() :
+    dataStart(0), dataSize(0), dataRead(0), blockAlign(0), flushed(false) {}
+
+bool WavStream::Open(const std::string& path, const SDL_AudioSpec& outputSpec) {
+    file = SDLIOStreamPtr(SDL_IOFromFile(path.c_str(), "rb"));
+    if (!file) {
+        std::cerr << "Failed to open audio: " << path << " Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    char tag[4];
+    Uint32 riffSize = 0;
+    if (!ReadTag(file.get(), tag) || std::memcmp(tag, "RIFF", 4) != 0 ||
+        !SDL_ReadU32LE(file.get(), &riffSize) || !ReadTag(file.get(), tag) ||
+        std::memcmp(tag, "WAVE", 4) != 0) {
+        std::cerr << "Not a WAV file: " << path << std::endl;
+        return false;
+    }
+
+    // Walk the chunk list for "fmt " and "data"; everything else is skipped
+    SDL_AudioSpec sourceSpec = {};
+    bool haveFormat = false;
+    Uint32 chunkSize = 0;
+    while (ReadTag(file.get(), tag) && SDL_ReadU32LE(file.get(), &chunkSize)) {
+        Sint64 chunkStart = SDL_TellIO(file.get());
+
+        if (std::memcmp(tag, "fmt ", 4) == 0) {
+            Uint16 formatTag = 0, channels = 0, bits = 0;
+            Uint32 rate = 0, byteRate = 0;
+            SDL_ReadU16LE(file.get(), &formatTag);
+            SDL_ReadU16LE(file.get(), &channels);
+            SDL_ReadU32LE(file.get(), &rate);
+            SDL_ReadU32LE(file.get(), &byteRate);
+            SDL_ReadU16LE(file.get(), &blockAlign);
+            SDL_ReadU16LE(file.get(), &bits);
+            if (formatTag == 0xFFFE && chunkSize >= 26) {
+                // WAVE_FORMAT_EXTENSIBLE: the real tag leads the sub-format GUID
+                Uint16 extensionSize = 0, validBits = 0;
+                Uint32 channelMask = 0;
+                SDL_ReadU16LE(file.get(), &extensionSize);
+                SDL_ReadU16LE(file.get(), &validBits);
+                SDL_ReadU32LE(file.get(), &channelMask);
+                SDL_ReadU16LE(file.get(), &formatTag);
+            }
+
+            sourceSpec.channels = channels;
+            sourceSpec.freq = static_cast<int>(rate);
+            if (formatTag == 1 && bits == 8) {
+                sourceSpec.format = SDL_AUDIO_U8;
+            } else if (formatTag == 1 && bits == 16) {
+                sourceSpec.format = SDL_AUDIO_S16LE;
+            } else if (formatTag == 1 && bits == 32) {
+                sourceSpec.format = SDL_AUDIO_S32LE;
+            } else if (formatTag == 3 && bits == 32) {
+                sourceSpec.format = SDL_AUDIO_F32LE;
+            } else {
+                std::cerr << "Unsupported WAV encoding (" << formatTag << ", " << bits
+                          << "-bit): " << path << std::endl;
+                return false;
+            }
+            // SDL's formats are tightly packed, so a padded layout can't be fed through
+            if (channels > 0 && blockAlign != channels * (bits / 8)) {
+                std::cerr << "Unsupported WAV block alignment (" << blockAlign << " for "
+                          << channels << " x " << bits << "-bit): " << path << std::endl;
+                return false;
+            }
+            haveFormat = channels > 0 && rate > 0;
+        } else if (std::memcmp(tag, "data", 4) == 0) {
+            dataStart = chunkStart;
+            dataSize = chunkSize;
+            break;
+        }
+
+        // Chunks are padded to an even length
+        SDL_SeekIO(file.get(), chunkStart + chunkSize + (chunkSize & 1), SDL_IO_SEEK_SET);
+    }
+
+    if (!haveFormat || dataStart == 0) {
+        std::cerr << "WAV file has no audio data: " << path << std::endl;
+        return false;
+    }
+
+    converter = SDLAudioStreamPtr(SDL_CreateAudioStream(&sourceSpec, &outputSpec));
+    if (!converter) {
+        std::cerr << "Failed to create audio converter: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // Whole frames only: SDL rejects data that ends partway through a frame
+    readBuffer.resize(std::max<size_t>(fileChunkBytes - fileChunkBytes % blockAlign, blockAlign));
+    dataRead = 0;
+    flushed = false;
+    return true;
+}
+
+bool WavStream::Rewind() {
+    if (!file || SDL_SeekIO(file.get(), dataStart, SDL_IO_SEEK_SET) < 0) {
+        return false;
+    }
+    SDL_ClearAudioStream(converter.get());
+    dataRead = 0;
+    flushed = false;
+    return true;
+}
+
+size_t WavStream::Read(float* out, size_t maxSamples) {
+    const int wantBytes = static_cast<int>(maxSamples * sizeof(float));
+    if (!file) {
+        return 0;
+    }
+
+    for (;;) {
+        int got = SDL_GetAudioStreamData(converter.get(), out, wantBytes);
+        if (got > 0) {
+            return static_cast<size_t>(got) / sizeof(float);
+        }
+        if (got < 0 || flushed) {
+            return 0;
+        }
+
+        // Feed the converter the next piece of the file
+        size_t want = static_cast<size_t>(std::min<Uint64>(readBuffer.size(), dataSize - dataRead));
+        want -= want % blockAlign;
+        size_t read = want > 0 ? SDL_ReadIO(file.get(), readBuffer.data(), want) : 0;
+
+        // A short read can stop mid-frame; the tail is read again with the next chunk
+        size_t partial = read % blockAlign;
+        if (partial > 0) {
+            SDL_SeekIO(file.get(), -static_cast<Sint64>(partial), SDL_IO_SEEK_CUR);
+            read -= partial;
+        }
+        if (read == 0) {
+            SDL_FlushAudioStream(converter.get());
+            flushed = true;
+            continue;
+        }
+        dataRead += read;
+        if (!SDL_PutAudioStreamData(converter.get(), readBuffer.data(), static_cast<int>(read))) {
+            std::cerr << "Failed to decode audio: " << SDL_GetError() << std::endl;
+            file.reset();
+            return 0;
+        }
+    }
+}
+
+AudioSystem::Channel::Channel(size_t ringSamples) :
+    ring(ringSamples), volume(1.0f), flushPending(false), streaming(false), gain(1.0f),
+    loop(false) {}
+
+AudioSystem::AudioSystem() :
+    spec{SDL_AUDIO_F32, CHANNELS, SAMPLE_RATE}, duckLevel(0.35f), underruns(0), running(false) {
+    for (auto& channel : channels) {
+        channel = std::make_unique<Channel>(ringSamples);
+    }
+    // Everything the callback touches is allocated here, never on the audio thread
+    mixBuffer.resize(mixBlockSamples);
+    channelBuffer.resize(mixBlockSamples);
+}
+
+AudioSystem::~AudioSystem() {
+    Shutdown();
+}
+
+bool AudioSystem::Initialize() {
+    if (!(SDL_WasInit(SDL_INIT_AUDIO) & SDL_INIT_AUDIO)) {
+        std::cerr << "Audio subsystem is not available" << std::endl;
+        return false;
+    }
+
+    deviceStream = SDLAudioStreamPtr(
+        SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, MixCallback, this));
+    if (!deviceStream) {
+        std::cerr << "Failed to open audio device: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    running = true;
+    worker = std::thread(&AudioSystem::WorkerLoop, this);
+
+    // Device streams start paused
+    SDL_ResumeAudioStreamDevice(deviceStream.get());
+    std::cout << "Audio driver: " << SDL_GetCurrentAudioDriver() << std::endl;
+    return true;
+}
+
+void AudioSystem::Shutdown() {
+    // Destroying the stream waits for any callback in flight
+    deviceStream.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        running = false;
+    }
+    commandSignal.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AudioSystem::Post(AudioChannel channel, const std::string& path, bool loop) {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        if (!running) {
+            return;
+        }
+        commands.push_back({channel, path, loop});
+    }
+    commandSignal.notify_one();
+}
+
+void AudioSystem::PlayMusic(const std::string& path, bool loop) {
+    Post(AudioChannel::MUSIC, path, loop);
+}
+
+void AudioSystem::StopMusic() {
+    Post(AudioChannel::MUSIC, std::string(), false);
+}
+
+void AudioSystem::PlayVoice(const std::string& path) {
+    Post(AudioChannel::VOICE, path, false);
+}
+
+void AudioSystem::StopVoice() {
+    Post(AudioChannel::VOICE, std::string(), false);
+}
+
+void AudioSystem::SetVolume(AudioChannel channel, float volume) {
+    GetChannel(channel).volume.store(std::clamp(volume, 0.0f, 1.0f));
+}
+
+bool AudioSystem::IsVoicePlaying() {
+    Channel& voice = GetChannel(AudioChannel::VOICE);
+    return voice.streaming.load() || voice.ring.Available() > 0;
+}
+
+void AudioSystem::WorkerLoop() {
+    std::vector<float> decodeBuffer(decodeChunkSamples);
+    std::unique_lock<std::mutex> lock(commandMutex);
+
+    while (running) {
+        while (!commands.empty()) {
+            Command command = std::move(commands.front());
+            commands.pop_front();
+            lock.unlock();
+            ApplyCommand(command);
+            lock.lock();
+        }
+
+        lock.unlock();
+        bool wrote = false;
+        for (auto& channel : channels) {
+            wrote |= FillChannel(*channel, decodeBuffer);
+        }
+        lock.lock();
+
+        if (!wrote && commands.empty() && running) {
+            commandSignal.wait_for(lock, workerIdle);
+        }
+    }
+}
+
+void AudioSystem::ApplyCommand(const Command& command) {
+    Channel& channel = GetChannel(command.channel);
+    channel.decoder.reset();
+    channel.streaming.store(false, std::memory_order_release);
+    channel.pendingPath = command.path;
+    channel.loop = command.loop;
+
+    // Only the callback may move the read side, so it drops the old clip; nothing
+    // new is written until it has
+    channel.flushPending.store(true, std::memory_order_release);
+}
+
+bool AudioSystem::FillChannel(Channel& channel, std::vector<float>& decodeBuffer) {
+    if (channel.flushPending.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    if (!channel.pendingPath.empty()) {
+        auto decoder = std::make_unique<WavStream>();
+        if (decoder->Open(channel.pendingPath, spec)) {
+            channel.decoder = std::move(decoder);
+        }
+        channel.pendingPath.clear();
+    }
+    if (!channel.decoder) {
+        return false;
+    }
+
+    bool wrote = false;
+    while (channel.ring.Free() >= decodeBuffer.size()) {
+        size_t samples = channel.decoder->Read(decodeBuffer.data(), decodeBuffer.size());
+        if (samples == 0 && channel.loop && channel.decoder->Rewind()) {
+            samples = channel.decoder->Read(decodeBuffer.data(), decodeBuffer.size());
+        }
+        if (samples == 0) {
+            channel.decoder.reset();
+            channel.streaming.store(false, std::memory_order_release);
+            break;
+        }
+
+        channel.ring.Write(decodeBuffer.data(), samples);
+        // Marked only once data is queued so a clip's start never counts as an underrun
+        channel.streaming.store(true, std::memory_order_release);
+        wrote = true;
+    }
+    return wrote;
+}
+
+void SDLCALL AudioSystem::MixCallback(void* userdata, SDL_AudioStream* stream,
+                                      int additionalAmount, int /* totalAmount */) {
+    static_cast<AudioSystem*>(userdata)->Mix(stream, additionalAmount);
+}
+
+void AudioSystem::Mix(SDL_AudioStream* stream, int bytes) {
+    size_t samplesNeeded = static_cast<size_t>(bytes) / sizeof(float);
+    samplesNeeded -= samplesNeeded % CHANNELS;
+
+    Channel& voice = GetChannel(AudioChannel::VOICE);
+
+    while (samplesNeeded > 0) {
+        size_t samples = std::min(samplesNeeded, mixBuffer.size());
+        std::fill_n(mixBuffer.begin(), samples, 0.0f);
+
+        bool voiceActive = voice.streaming.load(std::memory_order_acquire) ||
+                           voice.ring.Available() > 0;
+
+        for (size_t i = 0; i < channels.size(); i++) {
+            Channel& channel = *channels[i];
+            if (channel.flushPending.load(std::memory_order_acquire)) {
+                channel.ring.Discard();
+                channel.flushPending.store(false, std::memory_order_release);
+            }
+
+            size_t got = channel.ring.Read(channelBuffer.data(), samples);
+            if (got < samples && channel.streaming.load(std::memory_order_acquire)) {
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            float target = channel.volume.load(std::memory_order_relaxed);
+            if (static_cast<AudioChannel>(i) == AudioChannel::MUSIC && voiceActive) {
+                target *= duckLevel.load(std::memory_order_relaxed);
+            }
+
+            // Silent channels snap to their target so the next clip starts at the right level
+            float gain = got > 0 ? channel.gain : target;
+            for (size_t s = 0; s < got; s += CHANNELS) {
+                gain += std::clamp(target - gain, -gainStep, gainStep);
+                for (int c = 0; c < CHANNELS; c++) {
+                    mixBuffer[s + c] += channelBuffer[s + c] * gain;
+                }
+            }
+            channel.gain = gain;
+        }
+
+        for (size_t s = 0; s < samples; s++) {
+            mixBuffer[s] = std::clamp(mixBuffer[s], -1.0f, 1.0f);
+        }
+        SDL_PutAudioStreamData(stream, mixBuffer.data(), static_cast<int>(samples * sizeof(float)));
+        samplesNeeded -= samples;
+    }
+}
@@ -0,0 +1,219 @@
+#include "BackgroundPlayer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+// Everything is converted to this once on the worker, so uploads are plain copies
+const SDL_PixelFormat framePixelFormat = SDL_PIXELFORMAT_RGBA32;
+
+// Upper bound on how long the worker sleeps if a wake-up is missed
+const auto workerIdle = std::chrono::milliseconds(10);
+
+bool IsFrameFile(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+           extension == ".bmp" || extension == ".webp" || extension == ".tga" ||
+           extension == ".qoi";
+}
+
+// Copies `frame` into the preallocated `target`, converting and resizing as needed
+bool BlitFrame(SDL_Surface* frame, SDL_Surface* target) {
+    // Replace, don't blend: the slot still holds an older frame
+    SDL_SetSurfaceBlendMode(frame, SDL_BLENDMODE_NONE);
+    if (frame->w == target->w && frame->h == target->h) {
+        return SDL_BlitSurface(frame, nullptr, target, nullptr);
+    }
+    return SDL_BlitSurfaceScaled(frame, nullptr, target, nullptr, SDL_SCALEMODE_LINEAR);
+}
+} // namespace
+
+BackgroundPlayer::BackgroundPlayer(SDL_Renderer* renderer) :
+    renderer(renderer), shownTexture(0), hasFrame(false), slots(), decoded(SLOT_COUNT),
+    released(SLOT_COUNT), startNs(0), frameNs(1), shownFrame(0), droppedFrames(0),
+    clockFrame(0), running(false) {}
+
+BackgroundPlayer::~BackgroundPlayer() {
+    Close();
+}
+
+bool BackgroundPlayer::Open(const std::string& directory, int fps, float scale) {
+    // Check the new clip before stopping the current one, so a bad path leaves the
+    // old background playing
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file(error) && IsFrameFile(entry.path())) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "No frames in " << directory << std::endl;
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    // The first frame fixes the size every later frame is scaled to
+    auto first = make_surface_from_file(paths[0].c_str());
+    if (!first) {
+        std::cerr << "Failed to load frame: " << paths[0] << " Error: " << SDL_GetError()
+                  << std::endl;
+        return false;
+    }
+
+    Close();
+    framePaths = std::move(paths);
+    int w = std::max(1, static_cast<int>(std::lround(first->w * scale)));
+    int h = std::max(1, static_cast<int>(std::lround(first->h * scale)));
+
+    for (Slot& slot : slots) {
+        slot.surface = SDLSurfacePtr(SDL_CreateSurface(w, h, framePixelFormat));
+        slot.frame = 0;
+        if (!slot.surface) {
+            std::cerr << "Failed to allocate frame buffer: " << SDL_GetError() << std::endl;
+            Close();
+            return false;
+        }
+    }
+    for (SDLTexturePtr& texture : textures) {
+        texture = SDLTexturePtr(
+            SDL_CreateTexture(renderer, framePixelFormat, SDL_TEXTUREACCESS_STREAMING, w, h));
+        if (!texture) {
+            std::cerr << "Failed to create streaming texture: " << SDL_GetError() << std::endl;
+            Close();
+            return false;
+        }
+        // Backgrounds are opaque; skipping the blend saves fill rate
+        SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_NONE);
+    }
+
+    // Show the first frame right away; the worker picks up from the second
+    SDL_Surface* firstSlot = slots[0].surface.get();
+    if (!BlitFrame(first.get(), firstSlot) ||
+        !SDL_UpdateTexture(textures[0].get(), nullptr, firstSlot->pixels, firstSlot->pitch)) {
+        std::cerr << "Failed to upload frame: " << SDL_GetError() << std::endl;
+        Close();
+        return false;
+    }
+    shownTexture = 0;
+    shownFrame = 0;
+    hasFrame = true;
+    droppedFrames = 0;
+
+    frameNs = SDL_NS_PER_SECOND / static_cast<Uint64>(std::max(fps, 1));
+    startNs = SDL_GetTicksNS();
+    clockFrame.store(0);
+
+    // A still image needs no worker
+    if (framePaths.size() > 1) {
+        for (size_t i = 0; i < SLOT_COUNT; i++) {
+            released.Write(&i, 1);
+        }
+        running.store(true);
+        worker = std::thread(&BackgroundPlayer::WorkerLoop, this);
+    }
+    return true;
+}
+
+void BackgroundPlayer::Close() {
+    running.store(false);
+    wakeSignal.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    // Both rings are idle now, so this thread may empty either side
+    decoded.Discard();
+    released.Discard();
+
+    for (SDLTexturePtr& texture : textures) {
+        texture.reset();
+    }
+    for (Slot& slot : slots) {
+        slot.surface.reset();
+    }
+    framePaths.clear();
+    hasFrame = false;
+}
+
+bool BackgroundPlayer::DecodeInto(const std::string& path, SDL_Surface* target) const {
+    auto frame = make_surface_from_file(path.c_str());
+    if (!frame) {
+        std::cerr << "Failed to load frame: " << path << " Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    if (!BlitFrame(frame.get(), target)) {
+        std::cerr << "Failed to convert frame: " << path << " Error: " << SDL_GetError()
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void BackgroundPlayer::WorkerLoop() {
+    uint64_t next = 1;
+
+    while (running.load()) {
+        size_t slot = 0;
+        if (released.Read(&slot, 1) == 0) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeSignal.wait_for(lock, workerIdle,
+                                [this] { return !running.load() || released.Available() > 0; });
+            continue;
+        }
+
+        // After a stall, jump to the frame the clock has reached instead of replaying
+        // everything in between
+        next = std::max(next, clockFrame.load(std::memory_order_relaxed));
+
+        // A frame that fails to decode keeps the slot's old pixels; the timeline moves on
+        DecodeInto(framePaths[next % framePaths.size()], slots[slot].surface.get());
+        slots[slot].frame = next++;
+        decoded.Write(&slot, 1);
+    }
+}
+
+void BackgroundPlayer::Update(Uint64 nowNs) {
+    if (!running.load()) {
+        return;
+    }
+
+    uint64_t due = (nowNs - startNs) / frameNs;
+    clockFrame.store(due, std::memory_order_relaxed);
+    if (due <= shownFrame) {
+        return;
+    }
+
+    // Take the newest decoded frame that is due; older ones arrived too late to show
+    bool haveFrame = false;
+    size_t show = 0;
+    while (const size_t* front = decoded.Peek()) {
+        if (slots[*front].frame > due) {
+            break;
+        }
+        if (haveFrame) {
+            released.Write(&show, 1);
+            droppedFrames++;
+        }
+        decoded.Read(&show, 1);
+        haveFrame = true;
+    }
+    if (!haveFrame) {
+        return;
+    }
+
+    // Upload into the texture not on screen, so the one being drawn is never touched
+    size_t target = shownTexture ^ 1;
+    SDL_Surface* surface = slots[show].surface.get();
+    if (SDL_UpdateTexture(textures[target].get(), nullptr, surface->pixels, surface->pitch)) {
+        shownTexture = target;
+        shownFrame = slots[show].frame;
+    }
+    released.Write(&show, 1);
+    wakeSignal.notify_one();
+}
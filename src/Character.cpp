@@ -1,4 +1,5 @@
 #include "Character.h"
+#include "ResourceManager.h"
 
 Character::Character() : scale(1.0f), currentFrame(0), animationTime(0.0f), 
                         frameTime(0.1f), isAnimating(false) {
@@ -13,6 +14,7 @@ Character::~Character() {
 void Character::SetPart(CharacterLayer layer, std::shared_ptr<SDL_Texture> texture, const SDL_Rect& sourceRect) {
     layers[layer].texture = texture;
     layers[layer].sourceRect = sourceRect;
+    layers[layer].textureScale = ResourceManager::GetTextureScale(texture.get());
 }
 
 void Character::SetPartColor(CharacterLayer layer, const SDL_Color& color) {
@@ -61,7 +63,7 @@ void Character::Render(SDL_Renderer* renderer) {
                                   it->second.tintColor.b);
             SDL_SetTextureAlphaMod(it->second.texture.get(), it->second.tintColor.a);
             
-            // Calculate source rect for animation
+            // Calculate source rect for animation, then map it onto the loaded tier
             SDL_FRect srcRect;
             srcRect.x = static_cast<float>(it->second.sourceRect.x);
             srcRect.y = static_cast<float>(it->second.sourceRect.y);
@@ -70,6 +72,11 @@ void Character::Render(SDL_Renderer* renderer) {
             if (isAnimating && layer == CharacterLayer::BASE) {
                 srcRect.x = static_cast<float>(currentFrame * it->second.sourceRect.w);
             }
+            float textureScale = it->second.textureScale;
+            srcRect.x *= textureScale;
+            srcRect.y *= textureScale;
+            srcRect.w *= textureScale;
+            srcRect.h *= textureScale;
             
             SDL_RenderTexture(renderer, it->second.texture.get(), &srcRect, &destRect);
         }
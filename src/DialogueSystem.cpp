@@ -1,9 +1,26 @@
 #include "DialogueSystem.h"
+#include <algorithm>
 #include <iostream>
 
+namespace {
+// Tried after each locale's own fonts, so every chain ends in something that loads
+const char* const defaultFontPaths[] = {
+    "assets/fonts/arial.ttf",
+    "/System/Library/Fonts/Arial.ttf",  // macOS system font
+    "/System/Library/Fonts/Helvetica.ttc",  // macOS fallback
+};
+
+const int fontSize = 24;
+
+bool IsUtf8Continuation(char ch) {
+    return (static_cast<unsigned char>(ch) & 0xC0) == 0x80;
+}
+} // namespace
+
 DialogueSystem::DialogueSystem(SDL_Renderer* renderer) : 
-    renderer(renderer), typewriterSpeed(30.0f), typewriterTime(0.0f), 
-    currentCharIndex(0), isActive(false), isTyping(false) {
+    font(nullptr), renderer(renderer), localization(nullptr), localeRevision(0),
+    typewriterSpeed(30.0f), typewriterTime(0.0f), currentCharIndex(0),
+    textLayoutChars(0), layoutsDirty(true), isActive(false), isTyping(false) {
     
     // Set UI positions
     textboxRect = {100, 500, 1080, 180};
@@ -15,27 +32,51 @@ DialogueSystem::~DialogueSystem() {
     // Smart pointers handle cleanup automatically
 }
 
-bool DialogueSystem::Initialize() {
-    // Try multiple font paths
-    const char* fontPaths[] = {
-        "assets/fonts/arial.ttf",
-        "/System/Library/Fonts/Arial.ttf",  // macOS system font
-        "/System/Library/Fonts/Helvetica.ttc",  // macOS fallback
-        nullptr
-    };
+FontChain DialogueSystem::LoadFontChain(const std::vector<std::string>& paths, int ptsize) {
+    FontChain chain;
+    for (const std::string& path : paths) {
+        auto loaded = make_font(path.c_str(), ptsize);
+        if (!loaded) {
+            continue;
+        }
+        if (chain.fonts.empty()) {
+            std::cout << "Loaded font: " << path << std::endl;
+        } else {
+            TTF_AddFallbackFont(chain.fonts[0].get(), loaded.get());
+        }
+        chain.fonts.push_back(std::move(loaded));
+    }
+    return chain;
+}
     
-    for (int i = 0; fontPaths[i] != nullptr; ++i) {
-        font = make_font(fontPaths[i], 24);
-        if (font) {
-            std::cout << "Loaded font: " << fontPaths[i] << std::endl;
-            break;
+std::vector<FontChain> DialogueSystem::LoadFontChains(const Localization* localization) {
+    std::vector<FontChain> chains;
+    size_t localeCount = localization ? localization->GetLocaleCount() : 0;
+    for (size_t i = 0; i < std::max<size_t>(localeCount, 1); i++) {
+        std::vector<std::string> paths;
+        if (i < localeCount) {
+            paths = localization->GetFontPaths(i);
         }
+        paths.insert(paths.end(), std::begin(defaultFontPaths), std::end(defaultFontPaths));
+        chains.push_back(LoadFontChain(paths, fontSize));
     }
+    return chains;
+}
     
-    if (!font) {
+bool DialogueSystem::Initialize(const Localization* localization) {
+    return Initialize(localization, LoadFontChains(localization));
+}
+
+bool DialogueSystem::Initialize(const Localization* localization, std::vector<FontChain> chains) {
+    this->localization = localization;
+    fontChains = std::move(chains);
+
+    if (fontChains.empty() || !fontChains[0].GetPrimary()) {
         std::cerr << "Failed to load any font. Please add arial.ttf to assets/fonts/ or install system fonts." << std::endl;
         return false;
     }
+
+    SyncLocale();
     
     // Create textbox background
     auto surface = SDLSurfacePtr(SDL_CreateSurface(textboxRect.w, textboxRect.h, SDL_PIXELFORMAT_RGBA8888));
@@ -46,6 +87,50 @@ bool DialogueSystem::Initialize() {
     return true;
 }
 
+std::string_view DialogueSystem::GetSpeaker() const {
+    if (currentDialogue.speakerId >= 0 && localization) {
+        return localization->Get(currentDialogue.speakerId);
+    }
+    return currentDialogue.speaker;
+}
+
+std::string_view DialogueSystem::GetText() const {
+    if (currentDialogue.textId >= 0 && localization) {
+        return localization->Get(currentDialogue.textId);
+    }
+    return currentDialogue.text;
+}
+
+std::string_view DialogueSystem::GetChoiceText(const DialogueChoice& choice) const {
+    if (choice.textId >= 0 && localization) {
+        return localization->Get(choice.textId);
+    }
+    return choice.text;
+}
+
+void DialogueSystem::SyncLocale() {
+    size_t locale = localization ? localization->GetActiveLocale() : 0;
+    if (locale >= fontChains.size() || !fontChains[locale].GetPrimary()) {
+        locale = 0;
+    }
+    font = fontChains[locale].GetPrimary();
+    localeRevision = localization ? localization->GetRevision() : 0;
+
+    // The same line has a different length in the new locale: keep typing
+    // progress where possible, landing on a character boundary
+    std::string_view text = GetText();
+    if (!isTyping || currentCharIndex > text.size()) {
+        currentCharIndex = text.size();
+    }
+    while (currentCharIndex > 0 && currentCharIndex < text.size() &&
+           IsUtf8Continuation(text[currentCharIndex])) {
+        currentCharIndex--;
+    }
+
+    // Only the rendered text depends on the locale
+    layoutsDirty = true;
+}
+
 void DialogueSystem::AddDialogue(const DialogueNode& dialogue) {
     dialogueQueue.push(dialogue);
 }
@@ -54,19 +139,21 @@ void DialogueSystem::StartDialogue() {
     if (!dialogueQueue.empty()) {
         currentDialogue = dialogueQueue.front();
         dialogueQueue.pop();
-        displayedText.clear();
         currentCharIndex = 0;
         typewriterTime = 0.0f;
+        layoutsDirty = true;
         isActive = true;
         isTyping = true;
+        if (lineStartHandler) {
+            lineStartHandler(currentDialogue);
+        }
     }
 }
 
 void DialogueSystem::NextDialogue() {
     if (isTyping) {
         // Skip typewriter effect
-        displayedText = currentDialogue.text;
-        currentCharIndex = currentDialogue.text.length();
+        currentCharIndex = GetText().size();
         isTyping = false;
     } else if (!currentDialogue.hasChoices) {
         if (!dialogueQueue.empty()) {
@@ -78,91 +165,127 @@ void DialogueSystem::NextDialogue() {
 }
 
 void DialogueSystem::SelectChoice(int choiceIndex) {
-    if (currentDialogue.hasChoices && choiceIndex >= 0 && static_cast<size_t>(choiceIndex) < currentDialogue.choices.size()) {
-        // Handle choice selection - in a full implementation, this would trigger events
-        NextDialogue();
+    if (isTyping || !currentDialogue.hasChoices || choiceIndex < 0 ||
+        static_cast<size_t>(choiceIndex) >= currentDialogue.choices.size()) {
+        return;
+    }
+
+    int nextDialogueId = currentDialogue.choices[choiceIndex].nextDialogueId;
+    currentDialogue.hasChoices = false;
+    currentDialogue.choices.clear();
+    layoutsDirty = true;
+
+    if (!dialogueQueue.empty()) {
+        StartDialogue();
+    } else {
+        isActive = false;
+    }
+
+    // The handler may queue the branch's first line, so it runs after the menu is closed
+    if (choiceHandler) {
+        choiceHandler(nextDialogueId);
     }
 }
 
 void DialogueSystem::Update(float deltaTime) {
+    if (localization && localization->GetRevision() != localeRevision) {
+        SyncLocale();
+    }
+
     if (!isActive || !isTyping) return;
     
+    std::string_view text = GetText();
     typewriterTime += deltaTime * typewriterSpeed;
     
-    while (typewriterTime >= 1.0f && currentCharIndex < currentDialogue.text.length()) {
-        displayedText += currentDialogue.text[currentCharIndex];
+    while (typewriterTime >= 1.0f && currentCharIndex < text.length()) {
+        // Reveal whole UTF-8 sequences so the partial text is always valid
         currentCharIndex++;
+        while (currentCharIndex < text.length() && IsUtf8Continuation(text[currentCharIndex])) {
+            currentCharIndex++;
+        }
         typewriterTime -= 1.0f;
     }
     
-    if (currentCharIndex >= currentDialogue.text.length()) {
+    if (currentCharIndex >= text.length()) {
         isTyping = false;
     }
 }
 
+TextLayout DialogueSystem::MakeLayout(std::string_view text, SDL_Color color, int wrapWidth) const {
+    TextLayout layout;
+    if (text.empty() || !font) {
+        return layout;
+    }
+
+    auto surface = SDLSurfacePtr(wrapWidth > 0
+        ? TTF_RenderText_Blended_Wrapped(font, text.data(), text.size(), color, wrapWidth)
+        : TTF_RenderText_Blended(font, text.data(), text.size(), color));
+    if (surface) {
+        layout.texture = make_texture_from_surface(renderer, surface.get());
+        layout.w = static_cast<float>(surface->w);
+        layout.h = static_cast<float>(surface->h);
+    }
+    return layout;
+}
+
+void DialogueSystem::RebuildLayouts() {
+    speakerLayout = MakeLayout(GetSpeaker(), {255, 200, 100, 255}, 0);
+
+    choiceLayouts.clear();
+    if (currentDialogue.hasChoices) {
+        for (size_t i = 0; i < currentDialogue.choices.size(); i++) {
+            std::string label = std::to_string(i + 1) + ". ";
+            label += GetChoiceText(currentDialogue.choices[i]);
+            choiceLayouts.push_back(MakeLayout(label, {200, 200, 255, 255}, 0));
+        }
+    }
+
+    // Force the body text to re-render as well
+    textLayoutChars = std::string_view::npos;
+    layoutsDirty = false;
+}
+
 void DialogueSystem::Render() {
     if (!isActive) return;
+
+    if (localization && localization->GetRevision() != localeRevision) {
+        SyncLocale();
+    }
+    if (layoutsDirty) {
+        RebuildLayouts();
+    }
+    // The body only re-renders when the typewriter has revealed more of it
+    if (textLayoutChars != currentCharIndex) {
+        textLayout = MakeLayout(GetText().substr(0, currentCharIndex), {255, 255, 255, 255}, textRect.w);
+        textLayoutChars = currentCharIndex;
+    }
     
     // Render textbox background
     SDL_FRect fTextboxRect = {static_cast<float>(textboxRect.x), static_cast<float>(textboxRect.y), static_cast<float>(textboxRect.w), static_cast<float>(textboxRect.h)};
     SDL_RenderTexture(renderer, textboxTexture.get(), nullptr, &fTextboxRect);
     
     // Render speaker name
-    if (!currentDialogue.speaker.empty()) {
-        SDL_Color color = {255, 200, 100, 255};
-        auto speakerSurface = SDLSurfacePtr(TTF_RenderText_Blended(font.get(), 
-                                                                    currentDialogue.speaker.c_str(), 
-                                                                    0, color));
-        if (speakerSurface) {
-            auto speakerTexture = make_texture_from_surface(renderer, speakerSurface.get());
-            
-            SDL_Rect speakerDest = speakerRect;
-            speakerDest.w = speakerSurface->w;
-            speakerDest.h = speakerSurface->h;
-            
-            SDL_FRect fSpeakerDest = {static_cast<float>(speakerDest.x), static_cast<float>(speakerDest.y), static_cast<float>(speakerDest.w), static_cast<float>(speakerDest.h)};
-            SDL_RenderTexture(renderer, speakerTexture.get(), nullptr, &fSpeakerDest);
-        }
+    if (speakerLayout.texture) {
+        SDL_FRect fSpeakerDest = {static_cast<float>(speakerRect.x), static_cast<float>(speakerRect.y), speakerLayout.w, speakerLayout.h};
+        SDL_RenderTexture(renderer, speakerLayout.texture.get(), nullptr, &fSpeakerDest);
     }
     
     // Render dialogue text
-    if (!displayedText.empty()) {
-        SDL_Color color = {255, 255, 255, 255};
-        auto textSurface = SDLSurfacePtr(TTF_RenderText_Blended_Wrapped(font.get(), 
-                                                                        displayedText.c_str(), 
-                                                                        0, color, 
-                                                                        textRect.w));
-        if (textSurface) {
-            auto textTexture = make_texture_from_surface(renderer, textSurface.get());
-            
-            SDL_Rect textDest = textRect;
-            textDest.w = textSurface->w;
-            textDest.h = textSurface->h;
-            
-            SDL_FRect fTextDest = {static_cast<float>(textDest.x), static_cast<float>(textDest.y), static_cast<float>(textDest.w), static_cast<float>(textDest.h)};
-            SDL_RenderTexture(renderer, textTexture.get(), nullptr, &fTextDest);
-        }
+    if (textLayout.texture) {
+        SDL_FRect fTextDest = {static_cast<float>(textRect.x), static_cast<float>(textRect.y), textLayout.w, textLayout.h};
+        SDL_RenderTexture(renderer, textLayout.texture.get(), nullptr, &fTextDest);
     }
     
     // Render choices if available
     if (!isTyping && currentDialogue.hasChoices) {
         int yOffset = 0;
-        for (size_t i = 0; i < currentDialogue.choices.size(); i++) {
-            SDL_Color color = {200, 200, 255, 255};
-            auto choiceSurface = SDLSurfacePtr(TTF_RenderText_Blended(font.get(), 
-                                                                      currentDialogue.choices[i].text.c_str(), 
-                                                                      0, color));
-            if (choiceSurface) {
-                auto choiceTexture = make_texture_from_surface(renderer, choiceSurface.get());
-                
-                SDL_Rect choiceDest = {textRect.x, textRect.y - 40 - (yOffset * 35), 
-                                      choiceSurface->w, choiceSurface->h};
-                
-                SDL_FRect fChoiceDest = {static_cast<float>(choiceDest.x), static_cast<float>(choiceDest.y), static_cast<float>(choiceDest.w), static_cast<float>(choiceDest.h)};
-                SDL_RenderTexture(renderer, choiceTexture.get(), nullptr, &fChoiceDest);
+        for (const TextLayout& choice : choiceLayouts) {
+            if (choice.texture) {
+                SDL_FRect fChoiceDest = {static_cast<float>(textRect.x), static_cast<float>(textRect.y - 40 - (yOffset * 35)), choice.w, choice.h};
+                SDL_RenderTexture(renderer, choice.texture.get(), nullptr, &fChoiceDest);
             }
             
             yOffset++;
         }
     }
-}
\ No newline at end of file
+}
@@ -1,8 +1,55 @@
 #include "Game.h"
+#include <algorithm>
 #include <iostream>
 #include "ResourceManager.h"
+#include "ScriptCompiler.h"
+#include "TaskGraph.h"
 
-Game::Game() : isRunning(false), windowWidth(1280), windowHeight(720) {}
+namespace {
+struct PrefetchedImage {
+    std::string path;
+    SDLSurfacePtr surface;
+    float scale = 1.0f;
+};
+
+const char* const scriptPath = "assets/scripts/main.vns";
+const char* const readStatePath = "save/read_state.bin";
+const char* const localeManifestPath = "assets/lang/locales.txt";
+
+// Used when no script ships with the build, so the engine still has something to show
+const char* const fallbackScript = R"(
+say "Player" "Welcome to our visual novel game! Press SPACE to continue, Arrow keys to move."
+say "System" "You can customize your character using the number keys."
+)";
+
+// Images the script shows before its first line, decoded during startup
+std::vector<std::string> InitialImagePaths(const ScriptProgram& program) {
+    std::vector<std::string> paths;
+    for (const Instruction& in : program.code) {
+        if (in.op == OpCode::BACKGROUND) {
+            paths.push_back(program.strings[in.a]);
+        } else if (in.op == OpCode::SET_PART) {
+            paths.push_back(program.strings[in.b]);
+        } else if (in.op == OpCode::SAY || in.op == OpCode::MENU || in.op == OpCode::END ||
+                   in.op == OpCode::JMP) {
+            break;
+        }
+    }
+    return paths;
+}
+
+// Instructions the VM may run per frame before yielding back to the loop
+constexpr uint64_t scriptInstructionBudget = 100000;
+
+// While skipping, each frame spends this long advancing the script...
+constexpr auto skipSlice = std::chrono::milliseconds(8);
+// ...and only draws a frame this often
+constexpr Uint64 skipRenderIntervalMs = 100;
+} // namespace
+
+Game::Game() :
+    isRunning(false), windowWidth(1280), windowHeight(720), currentNodeId(-1),
+    lastRenderTicks(0), firstFramePresented(false) {}
 
 Game::~Game() {
     Clean();
@@ -11,62 +58,417 @@ Game::~Game() {
 bool Game::Initialize(const std::string& title, int width, int height) {
     windowWidth = width;
     windowHeight = height;
+    startupTime = std::chrono::steady_clock::now();
+    firstFramePresented = false;
+    
+    ResourceManager::Initialize();
+    
+    // Produced by worker tasks, consumed by the main-thread tasks that depend on them
+    std::vector<FontChain> fontChains;
+    std::vector<PrefetchedImage> images;
+    
+    // Window and renderer creation stay on this thread; fonts, locales, the script,
+    // the first scene's images and the audio device load alongside them
+    using Affinity = TaskGraph::Affinity;
+    TaskGraph startup;
+    
+    auto sdl = startup.Add("sdl", Affinity::Main, [this] {
+        if (!sdlManager.initialize()) {
+            std::cerr << "SDL Initialization Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        return true;
+    });
+    
+    auto windowTask = startup.Add("window", Affinity::Main, [this, &title] {
+        window = make_window(title.c_str(), windowWidth, windowHeight,
+                             SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
+        if (!window) {
+            std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        // The tier only needs the window's pixel size, so decoding can start before the renderer
+        UpdateAssetTier();
+        return true;
+    }, {sdl});
+    
+    auto rendererTask = startup.Add("renderer", Affinity::Main, [this] {
+        renderer = make_renderer(window.get(), nullptr);
+        if (!renderer) {
+            std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        
+        // Everything below lays out in LOGICAL_WIDTH x LOGICAL_HEIGHT
+        if (!SDL_SetRenderLogicalPresentation(renderer.get(), LOGICAL_WIDTH, LOGICAL_HEIGHT,
+                                              SDL_LOGICAL_PRESENTATION_LETTERBOX)) {
+            std::cerr << "SDL_SetRenderLogicalPresentation Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        ResourceManager::GetInstance().SetRenderer(renderer.get());
+        backgroundPlayer = std::make_unique<BackgroundPlayer>(renderer.get());
+        return true;
+    }, {windowTask});
+    
+    auto locales = startup.Add("locales", Affinity::Worker, [this] {
+        // Without a manifest the engine runs untranslated with the default fonts
+        localization = std::make_unique<Localization>();
+        if (!localization->LoadManifest(localeManifestPath)) {
+            std::cout << "No locales in " << localeManifestPath << "; using script text as-is"
+                      << std::endl;
+        }
+        return true;
+    });
+    
+    // TTF_Init happens in SDL setup
+    auto fonts = startup.Add("fonts", Affinity::Worker, [this, &fontChains] {
+        fontChains = DialogueSystem::LoadFontChains(localization.get());
+        return true;
+    }, {sdl, locales});
+    
+    auto script = startup.Add("script", Affinity::Worker, [this] {
+        if (!LoadScript(scriptPath)) {
+            std::cerr << "Failed to load story script" << std::endl;
+            return false;
+        }
+        return true;
+    });
+    
+    auto decode = startup.Add("decode-images", Affinity::Worker, [this, &images] {
+        const ResourceManager& resources = ResourceManager::GetInstance();
+        for (const std::string& path : InitialImagePaths(scriptVM->GetProgram())) {
+            PrefetchedImage image;
+            image.path = path;
+            image.surface = resources.DecodeImage(path, image.scale);
+            if (image.surface) {
+                images.push_back(std::move(image));
+            }
+        }
+        return true;
+    }, {windowTask, script});
+    
+    // Audio is optional; without a device the story plays silently
+    startup.Add("audio", Affinity::Worker, [this] {
+        if (sdlManager.isAudioAvailable()) {
+            audio = std::make_unique<AudioSystem>();
+            if (!audio->Initialize()) {
+                audio.reset();
+            }
+        }
+        return true;
+    }, {sdl});
+    
+    startup.Add("dialogue", Affinity::Main, [this, &fontChains] {
+        playerCharacter = std::make_unique<Character>();
+        
+        dialogueSystem = std::make_unique<DialogueSystem>(renderer.get());
+        if (!dialogueSystem->Initialize(localization.get(), std::move(fontChains))) {
+            std::cerr << "Failed to initialize dialogue system" << std::endl;
+            return false;
+        }
+        
+        // Choices carry the bytecode address of their branch
+        dialogueSystem->SetChoiceHandler([this](int target) { scriptVM->Choose(target); });
+        dialogueSystem->SetLineStartHandler(
+            [this](const DialogueNode& node) { OnLineStart(node); });
+        return true;
+    }, {rendererTask, fonts});
+    
+    // Uploads land in the cache, so the script's first bg/part commands find them there
+    startup.Add("upload-images", Affinity::Main, [&images] {
+        ResourceManager& resources = ResourceManager::GetInstance();
+        for (const PrefetchedImage& image : images) {
+            resources.AddTexture(image.path, image.surface.get(), image.scale);
+        }
+        return true;
+    }, {rendererTask, decode});
     
-    if (!sdlManager.initialize()) {
-        std::cerr << "SDL Initialization Error: " << SDL_GetError() << std::endl;
+    bool ok = startup.Run();
+    startup.PrintTimings(std::cout);
+    if (!ok) {
         return false;
     }
     
-    window = make_window(title.c_str(), windowWidth, windowHeight, 0);
+    isRunning = true;
+    AdvanceScript();
+    
+    return true;
+}
+
+bool Game::LoadScript(const std::string& path) {
+    ScriptCompiler compiler;
+    ScriptProgram program;
+    
+    if (!compiler.CompileFile(path, program)) {
+        std::cerr << "Script " << path << ": " << compiler.GetError() << std::endl;
+        if (!compiler.Compile(fallbackScript, program)) {
+            std::cerr << "Built-in script: " << compiler.GetError() << std::endl;
+            return false;
+        }
+    }
     
-    if (!window) {
-        std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
+    scriptVM = std::make_unique<ScriptVM>();
+    if (!scriptVM->Load(std::move(program))) {
         return false;
     }
     
-    renderer = make_renderer(window.get(), nullptr);
+    readState.Bind(scriptVM->GetProgram());
+    if (readState.Load(readStatePath)) {
+        std::cout << "Read state: " << readState.CountRead() << "/" << readState.GetNodeCount()
+                  << " lines seen" << std::endl;
+    }
+    return true;
+}
+
+void Game::AdvanceScript() {
+    // The reader has moved past whatever line was showing
+    readState.MarkRead(currentNodeId);
+    currentNodeId = -1;
     
-    if (!renderer) {
-        std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << std::endl;
-        return false;
+    for (;;) {
+        ScriptEvent event = scriptVM->Run(scriptInstructionBudget);
+        const Instruction& command = scriptVM->GetCommand();
+        
+        switch (event) {
+            case ScriptEvent::ShowText:
+                ShowLine(command);
+                return;
+            case ScriptEvent::SetBackground:
+                ApplyBackground(command);
+                break;
+            case ScriptEvent::SetPart:
+                ApplyPart(command);
+                break;
+            case ScriptEvent::SetVoice:
+                pendingVoice = scriptVM->GetString(command.a);
+                break;
+            case ScriptEvent::SetMusic:
+                ApplyMusic(command.a);
+                break;
+            case ScriptEvent::SetParticles:
+                ApplyParticles(command.a);
+                break;
+            case ScriptEvent::Choice:
+                ShowChoices();
+                return;
+            case ScriptEvent::Yield:
+            case ScriptEvent::Finished:
+            case ScriptEvent::Error:
+                return;
+        }
+    }
+}
+
+void Game::ResolveText(int32_t operand, std::string& text, int& textId) const {
+    // Localized lines stay as ids so a locale switch re-resolves them for free
+    if (IsLocalizedString(operand)) {
+        textId = LocalizedStringId(operand);
+    } else {
+        text = scriptVM->GetString(operand);
     }
+}
+
+void Game::ShowLine(const Instruction& say) {
+    DialogueNode node;
+    node.id = say.c;
+    ResolveText(say.a, node.speaker, node.speakerId);
+    ResolveText(say.b, node.text, node.textId);
+    node.voice = std::move(pendingVoice);
+    pendingVoice.clear();
+    dialogueSystem->AddDialogue(node);
+    dialogueSystem->StartDialogue();
+    currentNodeId = say.c;
+}
+
+void Game::ShowChoices() {
+    DialogueNode node;
+    node.hasChoices = true;
+    for (size_t i = 0; i < scriptVM->GetChoiceCount(); i++) {
+        const ScriptChoice& choice = scriptVM->GetChoice(i);
+        DialogueChoice option;
+        option.nextDialogueId = choice.target;
+        ResolveText(choice.text, option.text, option.textId);
+        node.choices.push_back(option);
+    }
+    dialogueSystem->AddDialogue(node);
+    dialogueSystem->StartDialogue();
+}
+
+void Game::ApplyBackground(const Instruction& background) {
+    const std::string& path = scriptVM->GetString(background.a);
+    if (background.op == OpCode::BACKGROUND_ANIM) {
+        // Frames stream in at the current asset tier; only a few are ever in memory.
+        // On failure the previous background stays up.
+        if (backgroundPlayer->Open(path, background.b,
+                                   ResourceManager::GetInstance().GetTierScale())) {
+            backgroundTexture.reset();
+        } else {
+            std::cerr << "Failed to start animated background: " << path << std::endl;
+        }
+    } else {
+        backgroundPlayer->Close();
+        backgroundTexture = ResourceManager::GetInstance().GetTexture(path);
+    }
+}
+
+void Game::ApplyPart(const Instruction& part) {
+    const ScriptRect& r = scriptVM->GetRect(part.c);
+    SDL_Rect sourceRect = {r.x, r.y, r.w, r.h};
+    playerCharacter->SetPart(static_cast<CharacterLayer>(part.a),
+                             ResourceManager::GetInstance().GetTexture(scriptVM->GetString(part.b)),
+                             sourceRect);
+}
+
+void Game::ApplyMusic(int32_t path) {
+    if (!audio) {
+        return;
+    }
+    if (path < 0) {
+        audio->StopMusic();
+    } else {
+        audio->PlayMusic(scriptVM->GetString(path));
+    }
+}
+
+void Game::ApplyParticles(int32_t preset) {
+    static_assert(static_cast<int32_t>(ParticlePreset::COUNT) == SCRIPT_PARTICLE_PRESET_COUNT,
+                  "ParticlePreset out of sync with SCRIPT_PARTICLE_PRESET_COUNT");
     
-    isRunning = true;
+    // The old effect drains naturally instead of vanishing mid-air
+    particles.StopAll();
+    if (preset >= 0) {
+        particles.Start(static_cast<ParticlePreset>(preset), static_cast<float>(LOGICAL_WIDTH),
+                        static_cast<float>(LOGICAL_HEIGHT));
+    }
+}
+
+void Game::OnLineStart(const DialogueNode& node) {
+    if (!audio) {
+        return;
+    }
+    // A new line always cuts off the previous voice, voiced or not
+    if (node.voice.empty()) {
+        audio->StopVoice();
+    } else {
+        audio->PlayVoice(node.voice);
+    }
+}
+
+void Game::StartSkip() {
+    if (skipMode.IsActive() || !scriptVM->IsRunnable() || dialogueSystem->HasChoices()) {
+        return;
+    }
     
-    // Initialize ResourceManager
-    ResourceManager::Initialize();
-    ResourceManager::GetInstance().SetRenderer(renderer.get());
+    // Whatever is on screen now counts as seen
+    readState.MarkRead(currentNodeId);
+    currentNodeId = -1;
+    skipMode.Start();
+}
+
+void Game::StopSkip() {
+    if (!skipMode.IsActive()) {
+        return;
+    }
     
-    // Initialize player character
-    playerCharacter = std::make_unique<Character>();
+    skipMode.Stop();
+    FlushSkipBatch();
+    std::cout << "Skipped " << skipMode.GetSkippedNodes() << " lines in "
+              << skipMode.GetElapsedSeconds() * 1000.0 << " ms ("
+              << static_cast<uint64_t>(skipMode.GetNodesPerSecond()) << " lines/s)" << std::endl;
+}
+
+void Game::UpdateSkip() {
+    auto deadline = SkipMode::Clock::now() + skipSlice;
     
-    // Initialize dialogue system
-    dialogueSystem = std::make_unique<DialogueSystem>(renderer.get());
-    if (!dialogueSystem->Initialize()) {
-        std::cerr << "Failed to initialize dialogue system" << std::endl;
-        return false;
+    switch (skipMode.Advance(*scriptVM, readState, deadline)) {
+        case SkipResult::Budget:
+            break;
+        case SkipResult::UnreadText:
+            StopSkip();
+            ShowLine(scriptVM->GetCommand());
+            break;
+        case SkipResult::Choice:
+            StopSkip();
+            ShowChoices();
+            break;
+        case SkipResult::Finished:
+            StopSkip();
+            break;
+    }
+}
+
+void Game::FlushSkipBatch() {
+    SkipBatch& batch = skipMode.GetBatch();
+    if (batch.IsEmpty()) {
+        return;
     }
     
-    // Load test dialogue
-    DialogueNode testDialogue;
-    testDialogue.speaker = "Player";
-    testDialogue.text = "Welcome to our visual novel game! Press SPACE to continue, Arrow keys to move.";
-    dialogueSystem->AddDialogue(testDialogue);
+    if (batch.background.op != OpCode::NOP) {
+        ApplyBackground(batch.background);
+    }
+    for (int32_t layer = 0; layer < SCRIPT_LAYER_COUNT; layer++) {
+        if (batch.partMask & (1u << layer)) {
+            ApplyPart(batch.parts[layer]);
+        }
+    }
+    if (batch.musicChanged) {
+        ApplyMusic(batch.music);
+    }
+    if (batch.particlesChanged) {
+        ApplyParticles(batch.particles);
+    }
+    if (batch.lastLine.op == OpCode::SAY) {
+        // Show the most recent skipped line fully typed out
+        ShowLine(batch.lastLine);
+        dialogueSystem->NextDialogue();
+    }
     
-    testDialogue.speaker = "System";
-    testDialogue.text = "You can customize your character using the number keys.";
-    dialogueSystem->AddDialogue(testDialogue);
+    // A voice cue after the last skipped line belongs to a line not reached yet
+    int32_t voice = batch.voice;
+    batch.Clear();
+    if (skipMode.IsActive()) {
+        batch.voice = voice;
+    } else if (voice >= 0) {
+        pendingVoice = scriptVM->GetString(voice);
+    }
+}
+
+void Game::CycleLocale() {
+    size_t count = localization->GetLocaleCount();
+    if (count < 2) {
+        return;
+    }
     
-    dialogueSystem->StartDialogue();
+    // Only flips the active table; DialogueSystem re-lays out its text on the next frame
+    size_t next = (localization->GetActiveLocale() + 1) % count;
+    localization->SetLocale(next);
+    std::cout << "Locale: " << localization->GetLocaleCode(next) << std::endl;
+}
+
+void Game::UpdateAssetTier() {
+    // Same as the renderer's output size, but available before the renderer exists
+    int outputWidth = 0;
+    int outputHeight = 0;
+    if (!SDL_GetWindowSizeInPixels(window.get(), &outputWidth, &outputHeight)) {
+        return;
+    }
     
-    return true;
+    // Letterboxing fits the smaller ratio
+    float outputScale = std::min(static_cast<float>(outputWidth) / LOGICAL_WIDTH,
+                                 static_cast<float>(outputHeight) / LOGICAL_HEIGHT);
+    ResourceManager& resources = ResourceManager::GetInstance();
+    if (resources.SetOutputScale(outputScale)) {
+        // Assets already on screen keep their tier until the script replaces them
+        std::cout << "Output " << outputWidth << "x" << outputHeight << ": using "
+                  << resources.GetTierScale() << "x assets" << std::endl;
+    }
 }
 
 void Game::Run() {
     const int FPS = 60;
     const int frameDelay = 1000 / FPS;
     
-    Uint32 frameStart;
+    Uint64 frameStart;
     int frameTime;
     float deltaTime = 0.0f;
     
@@ -75,7 +477,21 @@ void Game::Run() {
         
         HandleEvents();
         Update(deltaTime);
-        Render();
+        
+        // Skip mode only draws the occasional frame so the script can race ahead
+        if (!skipMode.IsActive() || frameStart - lastRenderTicks >= skipRenderIntervalMs) {
+            FlushSkipBatch();
+            Render();
+            lastRenderTicks = frameStart;
+            
+            if (!firstFramePresented) {
+                firstFramePresented = true;
+                auto elapsed = std::chrono::steady_clock::now() - startupTime;
+                std::cout << "Time to first frame: "
+                          << std::chrono::duration<double, std::milli>(elapsed).count() << " ms"
+                          << std::endl;
+            }
+        }
         
         frameTime = SDL_GetTicks() - frameStart;
         
@@ -94,11 +510,24 @@ void Game::HandleEvents() {
             case SDL_EVENT_QUIT:
                 isRunning = false;
                 break;
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                UpdateAssetTier();
+                break;
             case SDL_EVENT_KEY_DOWN:
                 if (event.key.key == SDLK_ESCAPE) {
                     isRunning = false;
+                } else if (event.key.key == SDLK_L) {
+                    CycleLocale();
+                } else if (event.key.key == SDLK_TAB) {
+                    if (skipMode.IsActive()) {
+                        StopSkip();
+                    } else {
+                        StartSkip();
+                    }
                 } else if (event.key.key == SDLK_SPACE) {
-                    if (dialogueSystem->IsActive()) {
+                    if (skipMode.IsActive()) {
+                        StopSkip();
+                    } else if (dialogueSystem->IsActive()) {
                         dialogueSystem->NextDialogue();
                     }
                 } else if (event.key.key == SDLK_LEFT) {
@@ -117,6 +546,9 @@ void Game::HandleEvents() {
                     auto pos = playerCharacter->GetPosition();
                     playerCharacter->SetPosition(pos.x, pos.y + 10);
                     playerCharacter->StartAnimation();
+                } else if (event.key.key >= SDLK_1 && event.key.key <= SDLK_9 &&
+                           dialogueSystem->IsActive() && dialogueSystem->HasChoices()) {
+                    dialogueSystem->SelectChoice(static_cast<int>(event.key.key - SDLK_1));
                 } else if (event.key.key >= SDLK_1 && event.key.key <= SDLK_5) {
                     // Character customization with number keys
                     int option = event.key.key - SDLK_1;
@@ -141,7 +573,16 @@ void Game::HandleEvents() {
 }
 
 void Game::Update(float deltaTime) {
+    if (skipMode.IsActive()) {
+        UpdateSkip();
+    } else if (!dialogueSystem->IsActive() && scriptVM->IsRunnable()) {
+        // Resume the script once the reader has finished with the current line
+        AdvanceScript();
+    }
+    
     playerCharacter->Update(deltaTime);
+    particles.Update(deltaTime);
+    backgroundPlayer->Update(SDL_GetTicksNS());
     dialogueSystem->Update(deltaTime);
 }
 
@@ -150,13 +591,18 @@ void Game::Render() {
     SDL_RenderClear(renderer.get());
     
     // Render background if available
-    if (backgroundTexture) {
+    if (backgroundPlayer->IsPlaying()) {
+        SDL_RenderTexture(renderer.get(), backgroundPlayer->GetTexture(), nullptr, nullptr);
+    } else if (backgroundTexture) {
         SDL_RenderTexture(renderer.get(), backgroundTexture.get(), nullptr, nullptr);
     }
     
     // Render character
     playerCharacter->Render(renderer.get());
     
+    // Weather and sparkles sit between the scene and the text box
+    particles.Render(renderer.get());
+    
     // Render dialogue
     dialogueSystem->Render();
     
@@ -164,9 +610,20 @@ void Game::Render() {
 }
 
 void Game::Clean() {
+    if (readState.IsDirty()) {
+        readState.Save(readStatePath);
+    }
+    
     playerCharacter.reset();
     dialogueSystem.reset();
+    localization.reset();
+    scriptVM.reset();
     backgroundTexture.reset();
+    backgroundPlayer.reset();
+    particles.Clear();
+    
+    // Joins the streaming thread before SDL shuts the audio subsystem down
+    audio.reset();
     
     ResourceManager::Shutdown();
     
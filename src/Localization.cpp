@@ -0,0 +1,99 @@
+#include "Localization.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+// Returns the compiled table for `source`, rebuilding it if the source is newer
+std::string CompiledTablePath(const std::string& source) {
+    namespace fs = std::filesystem;
+    fs::path sourcePath(source);
+    if (sourcePath.extension() == ".vnst") {
+        return source;
+    }
+
+    fs::path compiled = sourcePath;
+    compiled.replace_extension(".vnst");
+
+    std::error_code ec;
+    bool stale = !fs::exists(compiled, ec) ||
+                 fs::last_write_time(compiled, ec) < fs::last_write_time(sourcePath, ec);
+    if (stale && !StringTable::Compile(source, compiled.string())) {
+        return std::string();
+    }
+    return compiled.string();
+}
+} // namespace
+
+Localization::Localization() : active(0), revision(0) {}
+
+bool Localization::AddLocale(const std::string& code, const std::string& tablePath,
+                             const std::vector<std::string>& fontPaths) {
+    auto table = std::make_unique<StringTable>();
+    if (!tablePath.empty()) {
+        std::string compiled = CompiledTablePath(tablePath);
+        if (compiled.empty() || !table->Open(compiled)) {
+            std::cerr << "Locale " << code << " has no usable string table" << std::endl;
+            return false;
+        }
+    }
+
+    locales.push_back({code, std::move(table), fontPaths});
+    return true;
+}
+
+bool Localization::LoadManifest(const std::string& path) {
+    std::ifstream manifest(path);
+    if (!manifest) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::istringstream fields(line);
+        std::string code;
+        std::string table;
+        if (!(fields >> code) || code[0] == '#' || !(fields >> table)) {
+            continue;
+        }
+        std::vector<std::string> fonts;
+        std::string font;
+        while (fields >> font) {
+            fonts.push_back(font);
+        }
+        AddLocale(code, table, fonts);
+    }
+    return !locales.empty();
+}
+
+bool Localization::SetLocale(size_t index) {
+    if (index >= locales.size()) {
+        return false;
+    }
+    if (index != active) {
+        active = index;
+        revision++;
+    }
+    return true;
+}
+
+bool Localization::SetLocale(const std::string& code) {
+    for (size_t i = 0; i < locales.size(); i++) {
+        if (locales[i].code == code) {
+            return SetLocale(i);
+        }
+    }
+    return false;
+}
+
+std::string_view Localization::Get(int id) const {
+    if (locales.empty()) {
+        return {};
+    }
+    std::string_view text = locales[active].table->Get(id);
+    if (text.empty() && active != 0) {
+        text = locales[0].table->Get(id);
+    }
+    return text;
+}
@@ -0,0 +1,334 @@
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Frames longer than this (window drags, breakpoints) are clamped so nothing teleports
+const float maxDeltaTime = 0.1f;
+
+const float twoPi = 6.2831853f;
+
+// Corners of a particle quad, as offsets in half-sizes, and their texture coordinates
+const float cornerX[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+const float cornerY[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+const float cornerU[4] = {0.0f, 1.0f, 1.0f, 0.0f};
+const float cornerV[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+// Kept free of member access so the compiler sees plain arrays and vectorizes the loop.
+// The streams never overlap; __restrict says so, which saves GCC from giving up on
+// runtime alias checks between six arrays.
+void IntegrateKernel(float* __restrict px, float* __restrict py, float* __restrict vx,
+                     float* __restrict vy, float* __restrict age,
+                     const float* __restrict invLifetime, size_t count, float deltaVX,
+                     float deltaVY, float deltaTime) {
+    for (size_t i = 0; i < count; i++) {
+        vx[i] += deltaVX;
+        vy[i] += deltaVY;
+        px[i] += vx[i] * deltaTime;
+        py[i] += vy[i] * deltaTime;
+        age[i] += deltaTime * invLifetime[i];  // normalized: 1.0 is end of life
+    }
+}
+} // namespace
+
+ParticleEmitterConfig ParticleEmitterConfig::FromPreset(ParticlePreset preset, float width,
+                                                        float height) {
+    ParticleEmitterConfig config = {};
+    config.aspect = 1.0f;
+    config.endScale = 1.0f;
+    config.blendMode = SDL_BLENDMODE_BLEND;
+
+    switch (preset) {
+        case ParticlePreset::RAIN:
+            // Spawned above the screen and wide enough that the slant still covers it
+            config.spawnArea = {-0.2f * width, -40.0f, 1.2f * width, 20.0f};
+            config.spawnRate = 1800.0f;
+            config.lifetimeMin = config.lifetimeMax = (height + 60.0f) / 950.0f;
+            config.velocityXMin = 120.0f;
+            config.velocityXMax = 160.0f;
+            config.velocityYMin = 900.0f;
+            config.velocityYMax = 1000.0f;
+            config.sizeMin = 1.0f;
+            config.sizeMax = 1.5f;
+            config.aspect = 14.0f;
+            config.startColor = {0.7f, 0.75f, 0.9f, 0.5f};
+            config.endColor = {0.7f, 0.75f, 0.9f, 0.35f};
+            config.capacity = 2048;
+            break;
+        case ParticlePreset::SNOW:
+            config.spawnArea = {-0.1f * width, -20.0f, 1.2f * width, 10.0f};
+            config.spawnRate = 90.0f;
+            config.lifetimeMin = 8.0f;
+            config.lifetimeMax = 12.0f;
+            config.velocityXMin = -15.0f;
+            config.velocityXMax = 15.0f;
+            config.velocityYMin = 40.0f;
+            config.velocityYMax = 90.0f;
+            config.swayAmplitude = 30.0f;
+            config.swayFrequency = 0.3f;
+            config.sizeMin = 2.0f;
+            config.sizeMax = 4.5f;
+            config.startColor = {1.0f, 1.0f, 1.0f, 0.9f};
+            config.endColor = {1.0f, 1.0f, 1.0f, 0.6f};
+            config.capacity = 1024;
+            break;
+        case ParticlePreset::PETALS:
+            config.spawnArea = {-0.3f * width, -30.0f, 1.1f * width, 10.0f};
+            config.spawnRate = 25.0f;
+            config.lifetimeMin = 7.0f;
+            config.lifetimeMax = 10.0f;
+            config.velocityXMin = 30.0f;
+            config.velocityXMax = 80.0f;
+            config.velocityYMin = 50.0f;
+            config.velocityYMax = 100.0f;
+            config.gravity = 4.0f;
+            config.swayAmplitude = 60.0f;
+            config.swayFrequency = 0.25f;
+            config.sizeMin = 4.0f;
+            config.sizeMax = 7.0f;
+            config.aspect = 0.6f;
+            config.startColor = {1.0f, 0.72f, 0.8f, 0.95f};
+            config.endColor = {1.0f, 0.8f, 0.86f, 0.7f};
+            config.capacity = 512;
+            break;
+        case ParticlePreset::SPARKLES:
+            config.spawnArea = {0.0f, 0.0f, width, height};
+            config.spawnRate = 60.0f;
+            config.lifetimeMin = 0.6f;
+            config.lifetimeMax = 1.4f;
+            config.velocityXMin = -10.0f;
+            config.velocityXMax = 10.0f;
+            config.velocityYMin = -25.0f;
+            config.velocityYMax = -5.0f;
+            config.sizeMin = 2.0f;
+            config.sizeMax = 5.0f;
+            config.endScale = 0.0f;
+            config.startColor = {1.0f, 0.95f, 0.7f, 1.0f};
+            config.endColor = {1.0f, 0.85f, 0.4f, 0.0f};
+            config.blendMode = SDL_BLENDMODE_ADD;
+            config.capacity = 256;
+            break;
+        case ParticlePreset::COUNT:
+            break;
+    }
+    return config;
+}
+
+ParticleEmitter::ParticleEmitter() :
+    config(), count(0), spawnAccumulator(0.0f), time(0.0f), emitting(false),
+    rngState(0x9E3779B9u) {}
+
+void ParticleEmitter::Reset(const ParticleEmitterConfig& newConfig) {
+    config = newConfig;
+    texture.reset();
+    count = 0;
+    spawnAccumulator = 0.0f;
+    time = 0.0f;
+    emitting = true;
+
+    size_t capacity = config.capacity;
+    if (capacity <= posX.size()) {
+        return;
+    }
+
+    for (std::vector<float>* stream : {&posX, &posY, &velX, &velY, &age, &invLifetime, &size}) {
+        stream->resize(capacity);
+    }
+    vertices.resize(capacity * 4);
+
+    size_t first = indices.size() / 6;
+    indices.resize(capacity * 6);
+    for (size_t i = first; i < capacity; i++) {
+        int v = static_cast<int>(i * 4);
+        int* quad = &indices[i * 6];
+        quad[0] = v;
+        quad[1] = v + 1;
+        quad[2] = v + 2;
+        quad[3] = v;
+        quad[4] = v + 2;
+        quad[5] = v + 3;
+    }
+}
+
+float ParticleEmitter::Random01() {
+    // xorshift32: plenty for scattering particles, and cheap enough to call per particle
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return static_cast<float>(rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleEmitter::Spawn(size_t spawnCount) {
+    spawnCount = std::min(spawnCount, config.capacity - count);
+    for (size_t n = 0; n < spawnCount; n++) {
+        size_t i = count++;
+        posX[i] = config.spawnArea.x + config.spawnArea.w * Random01();
+        posY[i] = config.spawnArea.y + config.spawnArea.h * Random01();
+        velX[i] = RandomRange(config.velocityXMin, config.velocityXMax);
+        velY[i] = RandomRange(config.velocityYMin, config.velocityYMax);
+        age[i] = 0.0f;
+        float lifetime = RandomRange(config.lifetimeMin, config.lifetimeMax);
+        invLifetime[i] = 1.0f / std::max(lifetime, 0.001f);
+        size[i] = RandomRange(config.sizeMin, config.sizeMax);
+    }
+}
+
+void ParticleEmitter::Integrate(float deltaTime) {
+    // Acceleration is the same for every particle this frame, so the kernel is pure
+    // multiply-adds over contiguous arrays
+    float sway = config.swayAmplitude * std::sin(twoPi * config.swayFrequency * time);
+    IntegrateKernel(posX.data(), posY.data(), velX.data(), velY.data(), age.data(),
+                    invLifetime.data(), count, (config.wind + sway) * deltaTime,
+                    config.gravity * deltaTime, deltaTime);
+}
+
+void ParticleEmitter::RemoveDead() {
+    size_t i = 0;
+    while (i < count) {
+        if (age[i] < 1.0f) {
+            i++;
+            continue;
+        }
+        size_t last = --count;
+        posX[i] = posX[last];
+        posY[i] = posY[last];
+        velX[i] = velX[last];
+        velY[i] = velY[last];
+        age[i] = age[last];
+        invLifetime[i] = invLifetime[last];
+        size[i] = size[last];
+    }
+}
+
+void ParticleEmitter::Update(float deltaTime) {
+    deltaTime = std::min(deltaTime, maxDeltaTime);
+    time += deltaTime;
+
+    Integrate(deltaTime);
+    RemoveDead();
+
+    if (emitting) {
+        spawnAccumulator += config.spawnRate * deltaTime;
+        size_t spawnCount = static_cast<size_t>(spawnAccumulator);
+        spawnAccumulator -= static_cast<float>(spawnCount);
+        Spawn(spawnCount);
+    }
+}
+
+void ParticleEmitter::BuildGeometry() {
+    const SDL_FColor& c0 = config.startColor;
+    const SDL_FColor& c1 = config.endColor;
+    const float scaleDelta = config.endScale - 1.0f;
+
+    SDL_Vertex* out = vertices.data();
+    for (size_t i = 0; i < count; i++) {
+        float t = age[i];
+        SDL_FColor color = {c0.r + (c1.r - c0.r) * t, c0.g + (c1.g - c0.g) * t,
+                            c0.b + (c1.b - c0.b) * t, c0.a + (c1.a - c0.a) * t};
+        float halfW = 0.5f * size[i] * (1.0f + scaleDelta * t);
+        float halfH = halfW * config.aspect;
+
+        for (int corner = 0; corner < 4; corner++) {
+            SDL_Vertex& v = out[i * 4 + corner];
+            v.position = {posX[i] + cornerX[corner] * halfW, posY[i] + cornerY[corner] * halfH};
+            v.color = color;
+            v.tex_coord = {cornerU[corner], cornerV[corner]};
+        }
+    }
+}
+
+void ParticleEmitter::Render(SDL_Renderer* renderer) {
+    if (count == 0) {
+        return;
+    }
+    BuildGeometry();
+
+    // Untextured geometry blends with the draw blend mode, textured with the texture's
+    SDL_BlendMode previousMode = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode(renderer, &previousMode);
+    SDL_SetRenderDrawBlendMode(renderer, config.blendMode);
+    if (texture) {
+        SDL_SetTextureBlendMode(texture.get(), config.blendMode);
+    }
+
+    if (!SDL_RenderGeometry(renderer, texture.get(), vertices.data(), static_cast<int>(count * 4),
+                            indices.data(), static_cast<int>(count * 6))) {
+        std::cerr << "SDL_RenderGeometry Error: " << SDL_GetError() << std::endl;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, previousMode);
+}
+
+ParticleEmitter* ParticleSystem::Start(const ParticleEmitterConfig& config) {
+    // Prefer a pooled emitter that already has room, so its arrays are reused as-is
+    auto it = std::find_if(pool.begin(), pool.end(), [&](const auto& emitter) {
+        return emitter->GetStorageSize() >= config.capacity;
+    });
+    if (it == pool.end() && !pool.empty()) {
+        it = pool.begin();
+    }
+
+    std::unique_ptr<ParticleEmitter> emitter;
+    if (it != pool.end()) {
+        emitter = std::move(*it);
+        pool.erase(it);
+    } else {
+        emitter = std::make_unique<ParticleEmitter>();
+    }
+
+    emitter->Reset(config);
+    active.push_back(std::move(emitter));
+    return active.back().get();
+}
+
+ParticleEmitter* ParticleSystem::Start(ParticlePreset preset, float width, float height) {
+    return Start(ParticleEmitterConfig::FromPreset(preset, width, height));
+}
+
+void ParticleSystem::StopAll() {
+    for (auto& emitter : active) {
+        emitter->Stop();
+    }
+}
+
+void ParticleSystem::Release(std::unique_ptr<ParticleEmitter> emitter) {
+    emitter->SetTexture(nullptr);
+    pool.push_back(std::move(emitter));
+}
+
+void ParticleSystem::Clear() {
+    for (auto& emitter : active) {
+        Release(std::move(emitter));
+    }
+    active.clear();
+}
+
+void ParticleSystem::Update(float deltaTime) {
+    for (auto& emitter : active) {
+        emitter->Update(deltaTime);
+    }
+
+    // Drained emitters go back to the pool
+    for (auto it = active.begin(); it != active.end();) {
+        if ((*it)->IsFinished()) {
+            Release(std::move(*it));
+            it = active.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ParticleSystem::Render(SDL_Renderer* renderer) {
+    for (auto& emitter : active) {
+        emitter->Render(renderer);
+    }
+}
+
+size_t ParticleSystem::GetParticleCount() const {
+    size_t total = 0;
+    for (const auto& emitter : active) {
+        total += emitter->GetCount();
+    }
+    return total;
+}
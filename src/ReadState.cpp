@@ -0,0 +1,120 @@
+#include "ReadState.h"
+#include <algorithm>
+#include <bitset>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const char fileMagic[4] = {'V', 'N', 'R', 'S'};
+const uint32_t fileVersion = 1;
+
+void HashBytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+} // namespace
+
+ReadState::ReadState() : nodeCount(0), fingerprint(0), dirty(false) {}
+
+uint64_t ReadState::Fingerprint(const ScriptProgram& program) {
+    // FNV-1a over every line in node order: editing logic between lines keeps
+    // the read state, but adding, removing or rewording a line resets it
+    uint64_t hash = 14695981039346656037ull;
+    for (const Instruction& in : program.code) {
+        if (in.op != OpCode::SAY) {
+            continue;
+        }
+        HashBytes(hash, &in.c, sizeof(in.c));
+        if (IsLocalizedString(in.b)) {
+            // Translations may change freely; only the string id identifies the line
+            HashBytes(hash, &in.b, sizeof(in.b));
+        } else {
+            const std::string& text = program.strings[in.b];
+            HashBytes(hash, text.data(), text.size());
+        }
+    }
+    return hash;
+}
+
+void ReadState::Bind(const ScriptProgram& program) {
+    uint64_t newFingerprint = Fingerprint(program);
+    if (newFingerprint != fingerprint || static_cast<size_t>(program.nodeCount) != nodeCount) {
+        nodeCount = static_cast<size_t>(program.nodeCount);
+        words.assign((nodeCount + 63) / 64, 0);
+        fingerprint = newFingerprint;
+        dirty = false;
+    }
+}
+
+size_t ReadState::CountRead() const {
+    size_t count = 0;
+    for (uint64_t word : words) {
+        count += std::bitset<64>(word).count();
+    }
+    return count;
+}
+
+bool ReadState::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t storedFingerprint = 0;
+    uint64_t storedCount = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&storedFingerprint), sizeof(storedFingerprint));
+    file.read(reinterpret_cast<char*>(&storedCount), sizeof(storedCount));
+    if (!file || !std::equal(magic, magic + 4, fileMagic) || version != fileVersion) {
+        std::cerr << "Ignoring malformed read state: " << path << std::endl;
+        return false;
+    }
+    if (storedFingerprint != fingerprint || storedCount != nodeCount) {
+        std::cout << "Script changed since " << path << " was saved; read state reset" << std::endl;
+        return false;
+    }
+
+    std::vector<uint64_t> stored(words.size());
+    file.read(reinterpret_cast<char*>(stored.data()), stored.size() * sizeof(uint64_t));
+    if (!file) {
+        std::cerr << "Truncated read state: " << path << std::endl;
+        return false;
+    }
+    words = std::move(stored);
+    dirty = false;
+    return true;
+}
+
+bool ReadState::Save(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to write read state: " << path << std::endl;
+        return false;
+    }
+
+    uint64_t count = nodeCount;
+    file.write(fileMagic, sizeof(fileMagic));
+    file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+    file.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
+    if (!file) {
+        std::cerr << "Failed to write read state: " << path << std::endl;
+        return false;
+    }
+    dirty = false;
+    return true;
+}
@@ -1,8 +1,28 @@
 #include "ResourceManager.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 std::unique_ptr<ResourceManager> ResourceManager::instance = nullptr;
 
+namespace {
+const float tierScales[] = {0.5f, 1.0f, 2.0f};
+
+// Output scales this close above a tier still use it; the difference isn't visible
+const float tierTolerance = 1.1f;
+
+// "dir/name.png" at 0.5 -> "dir/name@0.5x.png"
+std::string TierPath(const std::string& path, float scale) {
+    std::string suffix = scale == 0.5f ? "@0.5x" : "@2x";
+    size_t slash = path.find_last_of("/\\");
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+} // namespace
+
 ResourceManager& ResourceManager::GetInstance() {
     if (!instance) {
         instance = std::make_unique<ResourceManager>(PrivateTag{});
@@ -29,6 +49,62 @@ void ResourceManager::SetRenderer(SDL_Renderer* renderer) {
     this->renderer = renderer;
 }
 
+bool ResourceManager::SetOutputScale(float outputScale) {
+    float tier = tierScales[0];
+    for (float candidate : tierScales) {
+        tier = candidate;
+        if (outputScale <= candidate * tierTolerance) {
+            break;
+        }
+    }
+    
+    if (tier == tierScale) {
+        return false;
+    }
+    tierScale = tier;
+    UnloadAll();
+    return true;
+}
+
+float ResourceManager::GetTextureScale(SDL_Texture* texture) {
+    if (!texture) {
+        return 1.0f;
+    }
+    return SDL_GetFloatProperty(SDL_GetTextureProperties(texture), VNE_PROP_TEXTURE_TIER_SCALE_FLOAT,
+                                1.0f);
+}
+
+SDLSurfacePtr ResourceManager::DecodeImage(const std::string& path, float& scale) const {
+    // Pre-scaled files win; they were resampled offline with better filters
+    if (tierScale != 1.0f) {
+        std::string tierPath = TierPath(path, tierScale);
+        SDL_PathInfo info;
+        if (SDL_GetPathInfo(tierPath.c_str(), &info)) {
+            auto surface = make_surface_from_file(tierPath.c_str());
+            if (surface) {
+                scale = tierScale;
+                return surface;
+            }
+        }
+    }
+    
+    scale = 1.0f;
+    auto surface = make_surface_from_file(path.c_str());
+    if (!surface || tierScale >= 1.0f) {
+        return surface;
+    }
+    
+    int w = std::max(1, static_cast<int>(std::lround(surface->w * tierScale)));
+    int h = std::max(1, static_cast<int>(std::lround(surface->h * tierScale)));
+    auto scaled = SDLSurfacePtr(SDL_ScaleSurface(surface.get(), w, h, SDL_SCALEMODE_LINEAR));
+    if (!scaled) {
+        std::cerr << "Failed to downscale " << path << ": " << SDL_GetError() << std::endl;
+        return surface;
+    }
+    scale = tierScale;
+    return scaled;
+}
+
 std::shared_ptr<SDL_Texture> ResourceManager::LoadTexture(const std::string& path) {
     // Check if texture is already loaded
     auto it = textures.find(path);
@@ -36,18 +112,25 @@ std::shared_ptr<SDL_Texture> ResourceManager::LoadTexture(const std::string& pat
         return it->second;
     }
     
-    // Load new texture
-    auto surface = make_surface_from_file(path.c_str());
+    // Load new texture at the current tier
+    float scale = 1.0f;
+    auto surface = DecodeImage(path, scale);
     if (!surface) {
         std::cerr << "Failed to load image: " << path << " Error: " << SDL_GetError() << std::endl;
         return nullptr;
     }
-    
-    auto texture = make_texture_from_surface(renderer, surface.get());
+    return AddTexture(path, surface.get(), scale);
+}
+
+std::shared_ptr<SDL_Texture> ResourceManager::AddTexture(const std::string& path,
+                                                         SDL_Surface* surface, float scale) {
+    auto texture = make_texture_from_surface(renderer, surface);
     if (!texture) {
         std::cerr << "Failed to create texture: " << path << " Error: " << SDL_GetError() << std::endl;
         return nullptr;
     }
+    SDL_SetFloatProperty(SDL_GetTextureProperties(texture.get()), VNE_PROP_TEXTURE_TIER_SCALE_FLOAT,
+                         scale);
     
     // Convert unique_ptr to shared_ptr for caching
     auto shared_texture = std::shared_ptr<SDL_Texture>(texture.release(), SDLTextureDeleter());
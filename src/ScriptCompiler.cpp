@@ -0,0 +1,434 @@
+#include "ScriptCompiler.h"
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Indices follow the CharacterLayer enum; the VM itself stays free of SDL types
+const char* const layerNames[] = {"base", "hair", "eyes", "outfit", "accessory"};
+static_assert(sizeof(layerNames) / sizeof(layerNames[0]) == SCRIPT_LAYER_COUNT,
+              "layer names out of sync with SCRIPT_LAYER_COUNT");
+
+// Indices follow the ParticlePreset enum
+const char* const particleNames[] = {"rain", "snow", "petals", "sparkles"};
+static_assert(sizeof(particleNames) / sizeof(particleNames[0]) == SCRIPT_PARTICLE_PRESET_COUNT,
+              "particle names out of sync with SCRIPT_PARTICLE_PRESET_COUNT");
+
+bool IsQuoted(const std::string& token) {
+    return !token.empty() && token.front() == '"';
+}
+
+bool ParseInt(const std::string& token, int32_t& value) {
+    if (token.empty()) {
+        return false;
+    }
+    size_t start = (token[0] == '-' || token[0] == '+') ? 1 : 0;
+    if (start == token.size()) {
+        return false;
+    }
+    for (size_t i = start; i < token.size(); i++) {
+        if (!std::isdigit(static_cast<unsigned char>(token[i]))) {
+            return false;
+        }
+    }
+    try {
+        long long parsed = std::stoll(token);
+        if (parsed < INT32_MIN || parsed > INT32_MAX) {
+            return false;
+        }
+        value = static_cast<int32_t>(parsed);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool IsIdentifier(const std::string& token) {
+    if (token.empty() || std::isdigit(static_cast<unsigned char>(token[0]))) {
+        return false;
+    }
+    for (char ch : token) {
+        if (!std::isalnum(static_cast<unsigned char>(ch)) && ch != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Comparison {
+    const char* token;
+    OpCode immediate;
+    OpCode variable;
+};
+
+const Comparison comparisons[] = {
+    {"==", OpCode::JMP_EQ, OpCode::JMP_EQ_VAR}, {"!=", OpCode::JMP_NE, OpCode::JMP_NE_VAR},
+    {"<", OpCode::JMP_LT, OpCode::JMP_LT_VAR},  {"<=", OpCode::JMP_LE, OpCode::JMP_LE_VAR},
+    {">", OpCode::JMP_GT, OpCode::JMP_GT_VAR},  {">=", OpCode::JMP_GE, OpCode::JMP_GE_VAR},
+};
+} // namespace
+
+ScriptCompiler::ScriptCompiler() : line(0), pendingChoices(0) {}
+
+bool ScriptCompiler::Fail(const std::string& message) {
+    error = "line " + std::to_string(line) + ": " + message;
+    return false;
+}
+
+bool ScriptCompiler::Tokenize(const std::string& text, std::vector<std::string>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        char ch = text[i];
+        if (std::isspace(static_cast<unsigned char>(ch))) {
+            i++;
+        } else if (ch == '#') {
+            break;
+        } else if (ch == '"') {
+            // Quoted tokens keep their leading quote so String() can tell them apart
+            std::string token = "\"";
+            i++;
+            bool closed = false;
+            while (i < text.size()) {
+                char c = text[i++];
+                if (c == '"') {
+                    closed = true;
+                    break;
+                }
+                if (c == '\\' && i < text.size()) {
+                    char escaped = text[i++];
+                    token += (escaped == 'n') ? '\n' : escaped;
+                } else {
+                    token += c;
+                }
+            }
+            if (!closed) {
+                return Fail("unterminated string");
+            }
+            tokens.push_back(std::move(token));
+        } else {
+            size_t start = i;
+            while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) &&
+                   text[i] != '"' && text[i] != '#') {
+                i++;
+            }
+            tokens.push_back(text.substr(start, i - start));
+        }
+    }
+    return true;
+}
+
+int32_t ScriptCompiler::Variable(const std::string& name) {
+    auto it = variables.find(name);
+    if (it != variables.end()) {
+        return it->second;
+    }
+    int32_t id = static_cast<int32_t>(program.variableNames.size());
+    program.variableNames.push_back(name);
+    variables[name] = id;
+    return id;
+}
+
+int32_t ScriptCompiler::Flag(const std::string& name) {
+    auto it = flags.find(name);
+    if (it != flags.end()) {
+        return it->second;
+    }
+    int32_t id = static_cast<int32_t>(program.flagNames.size());
+    program.flagNames.push_back(name);
+    flags[name] = id;
+    return id;
+}
+
+int32_t ScriptCompiler::String(const std::string& token) {
+    std::string text = token.substr(1);
+    auto it = strings.find(text);
+    if (it != strings.end()) {
+        return it->second;
+    }
+    int32_t id = static_cast<int32_t>(program.strings.size());
+    program.strings.push_back(text);
+    strings[text] = id;
+    return id;
+}
+
+bool ScriptCompiler::Text(const std::string& token, int32_t& id) {
+    if (IsQuoted(token)) {
+        id = String(token);
+        return true;
+    }
+    int32_t stringId = 0;
+    if (token.size() > 1 && token[0] == '@' && ParseInt(token.substr(1), stringId) &&
+        stringId >= 0 && stringId < SCRIPT_LOCALIZED_STRING) {
+        id = stringId | SCRIPT_LOCALIZED_STRING;
+        return true;
+    }
+    return false;
+}
+
+void ScriptCompiler::Emit(OpCode op, int32_t a, int32_t b, int32_t c) {
+    program.code.push_back({op, a, b, c});
+}
+
+void ScriptCompiler::EmitJump(OpCode op, int32_t a, int32_t b, int32_t Instruction::*field,
+                              const std::string& label) {
+    fixups.push_back({program.code.size(), field, label, line});
+    Emit(op, a, b, 0);
+}
+
+bool ScriptCompiler::CheckNoPendingChoices(const std::string& where) {
+    if (pendingChoices > 0) {
+        return Fail("choice without a menu before " + where);
+    }
+    return true;
+}
+
+bool ScriptCompiler::CompileStatement(const std::vector<std::string>& tokens) {
+    const std::string& keyword = tokens[0];
+    const size_t argc = tokens.size() - 1;
+
+    // Choices collect in the VM until the next MENU, so nothing that jumps, lands
+    // from a jump or waits for the player may sit between them
+    if (keyword == "label" || keyword == "goto" || keyword == "if" || keyword == "say" ||
+        keyword == "end") {
+        if (!CheckNoPendingChoices("'" + keyword + "'")) {
+            return false;
+        }
+    }
+
+    if (keyword == "label") {
+        if (argc != 1 || !IsIdentifier(tokens[1])) {
+            return Fail("expected: label NAME");
+        }
+        if (!labels.emplace(tokens[1], static_cast<int32_t>(program.code.size())).second) {
+            return Fail("duplicate label '" + tokens[1] + "'");
+        }
+    } else if (keyword == "goto") {
+        if (argc != 1 || !IsIdentifier(tokens[1])) {
+            return Fail("expected: goto NAME");
+        }
+        EmitJump(OpCode::JMP, 0, 0, &Instruction::a, tokens[1]);
+    } else if (keyword == "set" || keyword == "add" || keyword == "sub") {
+        int32_t value = 0;
+        if (argc != 2 || !IsIdentifier(tokens[1])) {
+            return Fail("expected: " + keyword + " VAR VALUE");
+        }
+        int32_t target = Variable(tokens[1]);
+        bool isSet = keyword == "set";
+        if (ParseInt(tokens[2], value)) {
+            if (keyword == "sub") {
+                if (value == INT32_MIN) {
+                    return Fail("value out of range");
+                }
+                value = -value;
+            }
+            Emit(isSet ? OpCode::SET : OpCode::ADD, target, value);
+        } else if (IsIdentifier(tokens[2]) && keyword != "sub") {
+            Emit(isSet ? OpCode::SET_VAR : OpCode::ADD_VAR, target, Variable(tokens[2]));
+        } else {
+            return Fail("bad value '" + tokens[2] + "'");
+        }
+    } else if (keyword == "flag" || keyword == "unflag") {
+        if (argc != 1 || !IsIdentifier(tokens[1])) {
+            return Fail("expected: " + keyword + " NAME");
+        }
+        Emit(keyword == "flag" ? OpCode::FLAG_SET : OpCode::FLAG_CLEAR, Flag(tokens[1]));
+    } else if (keyword == "if") {
+        if (argc < 3 || tokens[argc - 1] != "goto" || !IsIdentifier(tokens[argc])) {
+            return Fail("expected: if CONDITION goto NAME");
+        }
+        const std::string& label = tokens[argc];
+        if (argc == 3 && IsIdentifier(tokens[1])) {
+            EmitJump(OpCode::JMP_FLAG, Flag(tokens[1]), 0, &Instruction::b, label);
+        } else if (argc == 4 && tokens[1] == "not" && IsIdentifier(tokens[2])) {
+            EmitJump(OpCode::JMP_NOT_FLAG, Flag(tokens[2]), 0, &Instruction::b, label);
+        } else if (argc == 5 && IsIdentifier(tokens[1])) {
+            const Comparison* comparison = nullptr;
+            for (const Comparison& candidate : comparisons) {
+                if (tokens[2] == candidate.token) {
+                    comparison = &candidate;
+                }
+            }
+            if (!comparison) {
+                return Fail("unknown comparison '" + tokens[2] + "'");
+            }
+            int32_t lhs = Variable(tokens[1]);
+            int32_t value = 0;
+            if (ParseInt(tokens[3], value)) {
+                EmitJump(comparison->immediate, lhs, value, &Instruction::c, label);
+            } else if (IsIdentifier(tokens[3])) {
+                EmitJump(comparison->variable, lhs, Variable(tokens[3]), &Instruction::c, label);
+            } else {
+                return Fail("bad operand '" + tokens[3] + "'");
+            }
+        } else {
+            return Fail("malformed condition");
+        }
+    } else if (keyword == "say") {
+        int32_t speaker = -1;
+        int32_t text = 0;
+        if (argc == 1 && Text(tokens[1], text)) {
+            Emit(OpCode::SAY, -1, text, program.nodeCount++);
+        } else if (argc == 2 && Text(tokens[1], speaker) && Text(tokens[2], text)) {
+            Emit(OpCode::SAY, speaker, text, program.nodeCount++);
+        } else {
+            return Fail("expected: say [SPEAKER] TEXT");
+        }
+    } else if (keyword == "bg") {
+        if (argc != 1 || !IsQuoted(tokens[1])) {
+            return Fail("expected: bg \"PATH\"");
+        }
+        Emit(OpCode::BACKGROUND, String(tokens[1]));
+    } else if (keyword == "bganim") {
+        int32_t fps = 0;
+        if (argc != 2 || !IsQuoted(tokens[1]) || !ParseInt(tokens[2], fps)) {
+            return Fail("expected: bganim \"DIRECTORY\" FPS");
+        }
+        if (fps < 1 || fps > SCRIPT_MAX_ANIM_FPS) {
+            return Fail("bganim FPS must be 1-" + std::to_string(SCRIPT_MAX_ANIM_FPS));
+        }
+        Emit(OpCode::BACKGROUND_ANIM, String(tokens[1]), fps);
+    } else if (keyword == "voice") {
+        if (argc != 1 || !IsQuoted(tokens[1])) {
+            return Fail("expected: voice \"PATH\"");
+        }
+        Emit(OpCode::VOICE, String(tokens[1]));
+    } else if (keyword == "music") {
+        if (argc == 1 && tokens[1] == "stop") {
+            Emit(OpCode::MUSIC, -1);
+        } else if (argc == 1 && IsQuoted(tokens[1])) {
+            Emit(OpCode::MUSIC, String(tokens[1]));
+        } else {
+            return Fail("expected: music \"PATH\" or music stop");
+        }
+    } else if (keyword == "particles") {
+        if (argc != 1) {
+            return Fail("expected: particles rain|snow|petals|sparkles|off");
+        }
+        int32_t preset = -2;
+        if (tokens[1] == "off") {
+            preset = -1;
+        }
+        for (size_t i = 0; i < sizeof(particleNames) / sizeof(particleNames[0]); i++) {
+            if (tokens[1] == particleNames[i]) {
+                preset = static_cast<int32_t>(i);
+            }
+        }
+        if (preset == -2) {
+            return Fail("unknown particle effect '" + tokens[1] + "'");
+        }
+        Emit(OpCode::PARTICLES, preset);
+    } else if (keyword == "part") {
+        if (argc != 6 || !IsQuoted(tokens[2])) {
+            return Fail("expected: part LAYER \"PATH\" X Y W H");
+        }
+        int32_t layer = -1;
+        for (size_t i = 0; i < sizeof(layerNames) / sizeof(layerNames[0]); i++) {
+            if (tokens[1] == layerNames[i]) {
+                layer = static_cast<int32_t>(i);
+            }
+        }
+        if (layer < 0) {
+            return Fail("unknown layer '" + tokens[1] + "'");
+        }
+        ScriptRect rect;
+        if (!ParseInt(tokens[3], rect.x) || !ParseInt(tokens[4], rect.y) ||
+            !ParseInt(tokens[5], rect.w) || !ParseInt(tokens[6], rect.h)) {
+            return Fail("part rectangle must be four integers");
+        }
+        int32_t rectId = static_cast<int32_t>(program.rects.size());
+        program.rects.push_back(rect);
+        Emit(OpCode::SET_PART, layer, String(tokens[2]), rectId);
+    } else if (keyword == "choice") {
+        int32_t text = 0;
+        if (argc != 2 || !Text(tokens[1], text) || !IsIdentifier(tokens[2])) {
+            return Fail("expected: choice TEXT NAME");
+        }
+        if (pendingChoices == ScriptVM::MAX_CHOICES) {
+            return Fail("a menu holds at most " + std::to_string(ScriptVM::MAX_CHOICES) +
+                        " choices");
+        }
+        EmitJump(OpCode::CHOICE, text, 0, &Instruction::b, tokens[2]);
+        pendingChoices++;
+    } else if (keyword == "menu") {
+        if (argc != 0) {
+            return Fail("menu takes no arguments");
+        }
+        if (pendingChoices == 0) {
+            return Fail("menu without any choice");
+        }
+        Emit(OpCode::MENU);
+        pendingChoices = 0;
+    } else if (keyword == "end") {
+        if (argc != 0) {
+            return Fail("end takes no arguments");
+        }
+        Emit(OpCode::END);
+    } else {
+        return Fail("unknown statement '" + keyword + "'");
+    }
+    return true;
+}
+
+bool ScriptCompiler::ResolveLabels() {
+    for (const Fixup& fixup : fixups) {
+        auto it = labels.find(fixup.label);
+        if (it == labels.end()) {
+            line = fixup.line;
+            return Fail("undefined label '" + fixup.label + "'");
+        }
+        program.code[fixup.instruction].*fixup.field = it->second;
+    }
+    return true;
+}
+
+bool ScriptCompiler::Compile(const std::string& source, ScriptProgram& out) {
+    program = ScriptProgram();
+    labels.clear();
+    variables.clear();
+    flags.clear();
+    strings.clear();
+    fixups.clear();
+    error.clear();
+    line = 0;
+    pendingChoices = 0;
+
+    std::istringstream stream(source);
+    std::string text;
+    std::vector<std::string> tokens;
+    while (std::getline(stream, text)) {
+        line++;
+        if (!Tokenize(text, tokens)) {
+            return false;
+        }
+        if (!tokens.empty() && !CompileStatement(tokens)) {
+            return false;
+        }
+    }
+
+    if (!CheckNoPendingChoices("end of file")) {
+        return false;
+    }
+
+    // Falling off the end behaves like `end`, and labels placed last stay in range
+    Emit(OpCode::END);
+
+    if (!ResolveLabels()) {
+        return false;
+    }
+
+    out = std::move(program);
+    return true;
+}
+
+bool ScriptCompiler::CompileFile(const std::string& path, ScriptProgram& out) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return Compile(buffer.str(), out);
+}
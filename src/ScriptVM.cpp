@@ -0,0 +1,420 @@
+#include "ScriptVM.h"
+#include <algorithm>
+#include <iostream>
+
+// Labels-as-values give each handler its own indirect branch, which predicts far
+// better than a single switch. MSVC lacks the extension and falls back to a switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define VN_SCRIPT_THREADED_DISPATCH 1
+#endif
+
+namespace {
+const std::string emptyString;
+
+bool IsJumpTarget(int32_t target, size_t codeSize) {
+    return target >= 0 && static_cast<size_t>(target) < codeSize;
+}
+
+// Script arithmetic wraps around like two's complement instead of overflowing
+int32_t WrappingAdd(int32_t lhs, int32_t rhs) {
+    return static_cast<int32_t>(static_cast<uint32_t>(lhs) + static_cast<uint32_t>(rhs));
+}
+} // namespace
+
+ScriptVM::ScriptVM() :
+    choiceCount(0), pc(0), command{OpCode::NOP, 0, 0, 0}, loaded(false),
+    finished(false), awaitingChoice(false), executedCount(0) {}
+
+bool ScriptVM::Validate(const ScriptProgram& candidate) const {
+    const size_t codeSize = candidate.code.size();
+    const int32_t vars = static_cast<int32_t>(candidate.variableNames.size());
+    const int32_t flagCount = static_cast<int32_t>(candidate.flagNames.size());
+    const int32_t strings = static_cast<int32_t>(candidate.strings.size());
+    const int32_t rects = static_cast<int32_t>(candidate.rects.size());
+
+    auto isVar = [vars](int32_t v) { return v >= 0 && v < vars; };
+    auto isFlag = [flagCount](int32_t f) { return f >= 0 && f < flagCount; };
+    auto isString = [strings](int32_t s) { return s >= 0 && s < strings; };
+    auto isText = [&isString](int32_t s) { return isString(s) || IsLocalizedString(s); };
+
+    if (codeSize == 0 || candidate.code.back().op != OpCode::END) {
+        return false;
+    }
+
+    // CHOICEs seen since the last MENU; a menu needs between one and MAX_CHOICES
+    size_t pendingChoices = 0;
+
+    for (const Instruction& in : candidate.code) {
+        bool ok = true;
+        switch (in.op) {
+            case OpCode::NOP:
+            case OpCode::END:
+                break;
+            case OpCode::MENU:
+                ok = pendingChoices > 0;
+                pendingChoices = 0;
+                break;
+            case OpCode::SET:
+            case OpCode::ADD:
+                ok = isVar(in.a);
+                break;
+            case OpCode::SET_VAR:
+            case OpCode::ADD_VAR:
+                ok = isVar(in.a) && isVar(in.b);
+                break;
+            case OpCode::FLAG_SET:
+            case OpCode::FLAG_CLEAR:
+                ok = isFlag(in.a);
+                break;
+            case OpCode::JMP:
+                ok = IsJumpTarget(in.a, codeSize);
+                break;
+            case OpCode::JMP_FLAG:
+            case OpCode::JMP_NOT_FLAG:
+                ok = isFlag(in.a) && IsJumpTarget(in.b, codeSize);
+                break;
+            case OpCode::JMP_EQ:
+            case OpCode::JMP_NE:
+            case OpCode::JMP_LT:
+            case OpCode::JMP_LE:
+            case OpCode::JMP_GT:
+            case OpCode::JMP_GE:
+                ok = isVar(in.a) && IsJumpTarget(in.c, codeSize);
+                break;
+            case OpCode::JMP_EQ_VAR:
+            case OpCode::JMP_NE_VAR:
+            case OpCode::JMP_LT_VAR:
+            case OpCode::JMP_LE_VAR:
+            case OpCode::JMP_GT_VAR:
+            case OpCode::JMP_GE_VAR:
+                ok = isVar(in.a) && isVar(in.b) && IsJumpTarget(in.c, codeSize);
+                break;
+            case OpCode::SAY:
+                ok = (in.a == -1 || isText(in.a)) && isText(in.b) && in.c >= 0 &&
+                     in.c < candidate.nodeCount;
+                break;
+            case OpCode::BACKGROUND:
+            case OpCode::VOICE:
+                ok = isString(in.a);
+                break;
+            case OpCode::MUSIC:
+                ok = in.a == -1 || isString(in.a);
+                break;
+            case OpCode::BACKGROUND_ANIM:
+                ok = isString(in.a) && in.b >= 1 && in.b <= SCRIPT_MAX_ANIM_FPS;
+                break;
+            case OpCode::PARTICLES:
+                ok = in.a >= -1 && in.a < SCRIPT_PARTICLE_PRESET_COUNT;
+                break;
+            case OpCode::SET_PART:
+                ok = in.a >= 0 && in.a < SCRIPT_LAYER_COUNT && isString(in.b) && in.c >= 0 && in.c < rects;
+                break;
+            case OpCode::CHOICE:
+                ok = isText(in.a) && IsJumpTarget(in.b, codeSize) &&
+                     ++pendingChoices <= MAX_CHOICES;
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ScriptVM::Load(ScriptProgram compiled) {
+    if (!Validate(compiled)) {
+        std::cerr << "Script program failed validation" << std::endl;
+        loaded = false;
+        return false;
+    }
+
+    program = std::move(compiled);
+    loaded = true;
+    Reset();
+    return true;
+}
+
+void ScriptVM::Reset() {
+    variables.assign(program.variableNames.size(), 0);
+    flags.assign(program.flagNames.size(), 0);
+    choiceCount = 0;
+    pc = 0;
+    command = {OpCode::NOP, 0, 0, 0};
+    finished = !loaded;
+    awaitingChoice = false;
+    executedCount = 0;
+}
+
+bool ScriptVM::Choose(int target) {
+    if (!awaitingChoice) {
+        return false;
+    }
+    for (size_t i = 0; i < choiceCount; i++) {
+        if (choices[i].target == target) {
+            pc = static_cast<uint32_t>(target);
+            choiceCount = 0;
+            awaitingChoice = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::string& ScriptVM::GetString(int id) const {
+    if (id < 0 || static_cast<size_t>(id) >= program.strings.size()) {
+        return emptyString;
+    }
+    return program.strings[id];
+}
+
+int32_t ScriptVM::GetVariable(const std::string& name) const {
+    auto it = std::find(program.variableNames.begin(), program.variableNames.end(), name);
+    if (it == program.variableNames.end()) {
+        return 0;
+    }
+    return variables[it - program.variableNames.begin()];
+}
+
+bool ScriptVM::GetFlag(const std::string& name) const {
+    auto it = std::find(program.flagNames.begin(), program.flagNames.end(), name);
+    if (it == program.flagNames.end()) {
+        return false;
+    }
+    return flags[it - program.flagNames.begin()] != 0;
+}
+
+#if defined(VN_SCRIPT_THREADED_DISPATCH)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+ScriptEvent ScriptVM::Run(uint64_t budget) {
+    if (!loaded) {
+        return ScriptEvent::Error;
+    }
+    if (finished) {
+        return ScriptEvent::Finished;
+    }
+    if (awaitingChoice) {
+        return ScriptEvent::Choice;
+    }
+
+    // Everything the loop touches lives in locals; operands were range-checked in Load()
+    const Instruction* const code = program.code.data();
+    const Instruction* ip = code + pc;
+    int32_t* const vars = variables.data();
+    uint8_t* const flagBits = flags.data();
+    uint64_t executed = 0;
+    ScriptEvent event = ScriptEvent::Yield;
+
+// Budget is only checked on taken branches: straight-line code is bounded by program size
+// (a plain block rather than do/while so that DISPATCH() may be `continue` in switch mode)
+#define VN_JUMP(target)                                                                            \
+    {                                                                                              \
+        ip = code + (target);                                                                      \
+        if (executed >= budget) {                                                                  \
+            goto yield;                                                                            \
+        }                                                                                          \
+        DISPATCH();                                                                                \
+    }
+
+#define VN_COMPARE_IMM(name, cmp)                                                                  \
+    CASE(name) {                                                                                   \
+        if (vars[ip->a] cmp ip->b) {                                                               \
+            VN_JUMP(ip->c)                                                                         \
+        }                                                                                          \
+        ++ip;                                                                                      \
+        DISPATCH();                                                                                \
+    }
+
+#define VN_COMPARE_VAR(name, cmp)                                                                  \
+    CASE(name) {                                                                                   \
+        if (vars[ip->a] cmp vars[ip->b]) {                                                         \
+            VN_JUMP(ip->c)                                                                         \
+        }                                                                                          \
+        ++ip;                                                                                      \
+        DISPATCH();                                                                                \
+    }
+
+#if defined(VN_SCRIPT_THREADED_DISPATCH)
+    static const void* const dispatchTable[] = {
+#define VN_SCRIPT_LABEL(name) &&op_##name,
+        VN_SCRIPT_OPCODES(VN_SCRIPT_LABEL)
+#undef VN_SCRIPT_LABEL
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) ==
+                      static_cast<size_t>(OpCode::COUNT),
+                  "dispatch table out of sync with OpCode");
+
+#define CASE(name) op_##name:
+#define DISPATCH()                                                                                 \
+    do {                                                                                           \
+        ++executed;                                                                                \
+        goto* dispatchTable[static_cast<size_t>(ip->op)];                                          \
+    } while (0)
+
+    DISPATCH();
+#else
+#define CASE(name) case OpCode::name:
+#define DISPATCH() continue
+
+    for (;;) {
+        ++executed;
+        switch (ip->op) {
+#endif
+
+    CASE(NOP) {
+        ++ip;
+        DISPATCH();
+    }
+    CASE(END) {
+        finished = true;
+        event = ScriptEvent::Finished;
+        goto done;
+    }
+    CASE(SET) {
+        vars[ip->a] = ip->b;
+        ++ip;
+        DISPATCH();
+    }
+    CASE(SET_VAR) {
+        vars[ip->a] = vars[ip->b];
+        ++ip;
+        DISPATCH();
+    }
+    CASE(ADD) {
+        vars[ip->a] = WrappingAdd(vars[ip->a], ip->b);
+        ++ip;
+        DISPATCH();
+    }
+    CASE(ADD_VAR) {
+        vars[ip->a] = WrappingAdd(vars[ip->a], vars[ip->b]);
+        ++ip;
+        DISPATCH();
+    }
+    CASE(FLAG_SET) {
+        flagBits[ip->a] = 1;
+        ++ip;
+        DISPATCH();
+    }
+    CASE(FLAG_CLEAR) {
+        flagBits[ip->a] = 0;
+        ++ip;
+        DISPATCH();
+    }
+    CASE(JMP) {
+        VN_JUMP(ip->a)
+    }
+    CASE(JMP_FLAG) {
+        if (flagBits[ip->a]) {
+            VN_JUMP(ip->b)
+        }
+        ++ip;
+        DISPATCH();
+    }
+    CASE(JMP_NOT_FLAG) {
+        if (!flagBits[ip->a]) {
+            VN_JUMP(ip->b)
+        }
+        ++ip;
+        DISPATCH();
+    }
+    VN_COMPARE_IMM(JMP_EQ, ==)
+    VN_COMPARE_IMM(JMP_NE, !=)
+    VN_COMPARE_IMM(JMP_LT, <)
+    VN_COMPARE_IMM(JMP_LE, <=)
+    VN_COMPARE_IMM(JMP_GT, >)
+    VN_COMPARE_IMM(JMP_GE, >=)
+    VN_COMPARE_VAR(JMP_EQ_VAR, ==)
+    VN_COMPARE_VAR(JMP_NE_VAR, !=)
+    VN_COMPARE_VAR(JMP_LT_VAR, <)
+    VN_COMPARE_VAR(JMP_LE_VAR, <=)
+    VN_COMPARE_VAR(JMP_GT_VAR, >)
+    VN_COMPARE_VAR(JMP_GE_VAR, >=)
+    CASE(SAY) {
+        command = *ip++;
+        event = ScriptEvent::ShowText;
+        goto done;
+    }
+    CASE(BACKGROUND) {
+        command = *ip++;
+        event = ScriptEvent::SetBackground;
+        goto done;
+    }
+    CASE(BACKGROUND_ANIM) {
+        command = *ip++;
+        event = ScriptEvent::SetBackground;
+        goto done;
+    }
+    CASE(SET_PART) {
+        command = *ip++;
+        event = ScriptEvent::SetPart;
+        goto done;
+    }
+    CASE(VOICE) {
+        command = *ip++;
+        event = ScriptEvent::SetVoice;
+        goto done;
+    }
+    CASE(MUSIC) {
+        command = *ip++;
+        event = ScriptEvent::SetMusic;
+        goto done;
+    }
+    CASE(PARTICLES) {
+        command = *ip++;
+        event = ScriptEvent::SetParticles;
+        goto done;
+    }
+    CASE(CHOICE) {
+        // Validate() caps each menu at MAX_CHOICES; the check guards a jump that runs
+        // the same CHOICEs again
+        if (choiceCount < MAX_CHOICES) {
+            choices[choiceCount++] = {ip->a, ip->b};
+        }
+        ++ip;
+        DISPATCH();
+    }
+    CASE(MENU) {
+        // A jump past the CHOICEs leaves a menu nobody can answer; stop instead of
+        // waiting on it forever
+        if (choiceCount == 0) {
+            finished = true;
+            event = ScriptEvent::Error;
+            goto done;
+        }
+        ++ip;
+        awaitingChoice = true;
+        event = ScriptEvent::Choice;
+        goto done;
+    }
+
+#if !defined(VN_SCRIPT_THREADED_DISPATCH)
+            default:
+                event = ScriptEvent::Error;
+                goto done;
+        }
+    }
+#endif
+
+yield:
+    event = ScriptEvent::Yield;
+
+done:
+    pc = static_cast<uint32_t>(ip - code);
+    executedCount += executed;
+    return event;
+
+#undef CASE
+#undef DISPATCH
+#undef VN_COMPARE_VAR
+#undef VN_COMPARE_IMM
+#undef VN_JUMP
+}
+
+#if defined(VN_SCRIPT_THREADED_DISPATCH)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,107 @@
+#include "SkipMode.h"
+
+namespace {
+// The clock is consulted every this many script events, or sooner once this many
+// instructions have run, so a loop-heavy stretch can't overrun the time slice
+constexpr int deadlineCheckInterval = 64;
+constexpr uint64_t deadlineCheckInstructions = 100000;
+
+// One Run() never goes past the instruction check; a Yield just means "look at the clock"
+constexpr uint64_t skipInstructionBudget = deadlineCheckInstructions;
+} // namespace
+
+void SkipBatch::Clear() {
+    background = {OpCode::NOP, 0, 0, 0};
+    partMask = 0;
+    lastLine = {OpCode::NOP, 0, 0, 0};
+    musicChanged = false;
+    music = -1;
+    voice = -1;
+    particlesChanged = false;
+    particles = -1;
+}
+
+SkipMode::SkipMode() : active(false), skippedNodes(0) {}
+
+void SkipMode::Start() {
+    if (active) {
+        return;
+    }
+    active = true;
+    skippedNodes = 0;
+    batch.Clear();
+    startTime = Clock::now();
+    stopTime = startTime;
+}
+
+void SkipMode::Stop() {
+    if (active) {
+        active = false;
+        stopTime = Clock::now();
+    }
+}
+
+double SkipMode::GetElapsedSeconds() const {
+    Clock::time_point end = active ? Clock::now() : stopTime;
+    return std::chrono::duration<double>(end - startTime).count();
+}
+
+double SkipMode::GetNodesPerSecond() const {
+    double seconds = GetElapsedSeconds();
+    return seconds > 0.0 ? static_cast<double>(skippedNodes) / seconds : 0.0;
+}
+
+SkipResult SkipMode::Advance(ScriptVM& vm, ReadState& readState, Clock::time_point deadline) {
+    int untilCheck = deadlineCheckInterval;
+    uint64_t checkAtInstruction = vm.GetExecutedCount() + deadlineCheckInstructions;
+
+    for (;;) {
+        if (--untilCheck == 0 || vm.GetExecutedCount() >= checkAtInstruction) {
+            untilCheck = deadlineCheckInterval;
+            checkAtInstruction = vm.GetExecutedCount() + deadlineCheckInstructions;
+            if (Clock::now() >= deadline) {
+                return SkipResult::Budget;
+            }
+        }
+
+        ScriptEvent event = vm.Run(skipInstructionBudget);
+        const Instruction& command = vm.GetCommand();
+
+        switch (event) {
+            case ScriptEvent::ShowText:
+                if (!readState.IsRead(command.c)) {
+                    return SkipResult::UnreadText;
+                }
+                // Skipped lines are never voiced
+                batch.lastLine = command;
+                batch.voice = -1;
+                skippedNodes++;
+                break;
+            case ScriptEvent::SetBackground:
+                batch.background = command;
+                break;
+            case ScriptEvent::SetPart:
+                batch.parts[command.a] = command;
+                batch.partMask |= 1u << command.a;
+                break;
+            case ScriptEvent::SetVoice:
+                batch.voice = command.a;
+                break;
+            case ScriptEvent::SetMusic:
+                batch.musicChanged = true;
+                batch.music = command.a;
+                break;
+            case ScriptEvent::SetParticles:
+                batch.particlesChanged = true;
+                batch.particles = command.a;
+                break;
+            case ScriptEvent::Choice:
+                return SkipResult::Choice;
+            case ScriptEvent::Yield:
+                break;
+            case ScriptEvent::Finished:
+            case ScriptEvent::Error:
+                return SkipResult::Finished;
+        }
+    }
+}
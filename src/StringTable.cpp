@@ -0,0 +1,183 @@
+#include "StringTable.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const char fileMagic[4] = {'V', 'N', 'S', 'T'};
+const uint32_t fileVersion = 1;
+const size_t headerSize = sizeof(fileMagic) + 2 * sizeof(uint32_t);
+} // namespace
+
+StringTable::StringTable() :
+    data(nullptr), size(0), offsets(nullptr), blob(nullptr), count(0) {}
+
+StringTable::~StringTable() {
+    Unmap();
+}
+
+void StringTable::Unmap() {
+#ifdef _WIN32
+    buffer.clear();
+    buffer.shrink_to_fit();
+#else
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    offsets = nullptr;
+    blob = nullptr;
+    count = 0;
+}
+
+bool StringTable::Open(const std::string& path) {
+    Unmap();
+
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open string table: " << path << std::endl;
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open string table: " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        std::cerr << "Empty string table: " << path << std::endl;
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map string table: " << path << std::endl;
+        return false;
+    }
+    data = static_cast<const char*>(mapped);
+    size = static_cast<size_t>(info.st_size);
+#endif
+
+    // Validate once here so Get() can index without checks
+    uint32_t version = 0;
+    uint32_t stringCount = 0;
+    if (size < headerSize || std::memcmp(data, fileMagic, sizeof(fileMagic)) != 0) {
+        std::cerr << "Not a string table: " << path << std::endl;
+        Unmap();
+        return false;
+    }
+    std::memcpy(&version, data + 4, sizeof(version));
+    std::memcpy(&stringCount, data + 8, sizeof(stringCount));
+    size_t offsetBytes = (static_cast<size_t>(stringCount) + 1) * sizeof(uint32_t);
+    if (version != fileVersion || size < headerSize + offsetBytes) {
+        std::cerr << "Unsupported string table: " << path << std::endl;
+        Unmap();
+        return false;
+    }
+
+    offsets = reinterpret_cast<const uint32_t*>(data + headerSize);
+    blob = data + headerSize + offsetBytes;
+    size_t blobSize = size - headerSize - offsetBytes;
+    for (uint32_t i = 0; i < stringCount; i++) {
+        if (offsets[i] >= offsets[i + 1] || offsets[i + 1] > blobSize ||
+            blob[offsets[i + 1] - 1] != '\0') {
+            std::cerr << "Corrupt string table: " << path << std::endl;
+            Unmap();
+            return false;
+        }
+    }
+    count = stringCount;
+    return true;
+}
+
+bool StringTable::Write(const std::string& path, const std::vector<std::string>& strings) {
+    std::vector<uint32_t> table;
+    table.reserve(strings.size() + 1);
+    uint32_t offset = 0;
+    for (const std::string& s : strings) {
+        table.push_back(offset);
+        offset += static_cast<uint32_t>(s.size()) + 1;
+    }
+    table.push_back(offset);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to write string table: " << path << std::endl;
+        return false;
+    }
+    uint32_t stringCount = static_cast<uint32_t>(strings.size());
+    file.write(fileMagic, sizeof(fileMagic));
+    file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+    file.write(reinterpret_cast<const char*>(&stringCount), sizeof(stringCount));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(uint32_t));
+    for (const std::string& s : strings) {
+        file.write(s.c_str(), s.size() + 1);
+    }
+    return static_cast<bool>(file);
+}
+
+bool StringTable::Compile(const std::string& sourcePath, const std::string& outputPath) {
+    std::ifstream source(sourcePath);
+    if (!source) {
+        std::cerr << "Failed to open string source: " << sourcePath << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> strings;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(source, line)) {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        size_t end = start;
+        while (end < line.size() && std::isdigit(static_cast<unsigned char>(line[end]))) {
+            end++;
+        }
+        // Seven digits keeps a typo from sizing the table to billions of entries
+        if (end == start || end - start > 7 || end >= line.size() ||
+            (line[end] != ' ' && line[end] != '\t')) {
+            std::cerr << sourcePath << ":" << lineNumber << ": expected \"<id> <text>\""
+                      << std::endl;
+            return false;
+        }
+        size_t id = std::stoul(line.substr(start, end - start));
+
+        std::string text;
+        for (size_t i = line.find_first_not_of(" \t", end); i < line.size(); i++) {
+            if (line[i] == '\\' && i + 1 < line.size()) {
+                char escaped = line[++i];
+                text += (escaped == 'n') ? '\n' : escaped;
+            } else if (line[i] != '\r') {
+                text += line[i];
+            }
+        }
+
+        if (id >= strings.size()) {
+            strings.resize(id + 1);
+        }
+        strings[id] = std::move(text);
+    }
+
+    return Write(outputPath, strings);
+}
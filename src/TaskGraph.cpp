@@ -0,0 +1,197 @@
+#include "TaskGraph.h"
+#include <algorithm>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <system_error>
+#include <thread>
+
+namespace {
+const char* StateName(TaskGraph::TaskState state) {
+    switch (state) {
+        case TaskGraph::TaskState::Pending: return "pending";
+        case TaskGraph::TaskState::Done: return "ok";
+        case TaskGraph::TaskState::Failed: return "FAILED";
+        case TaskGraph::TaskState::Skipped: return "skipped";
+    }
+    return "?";
+}
+} // namespace
+
+TaskGraph::TaskGraph() : wallMs(0.0), unfinished(0), aborted(false) {}
+
+TaskGraph::TaskId TaskGraph::Add(const std::string& name, Affinity affinity,
+                                 std::function<bool()> work,
+                                 const std::vector<TaskId>& dependencies) {
+    TaskId id = tasks.size();
+    size_t dependencyCount = 0;
+    for (TaskId dependency : dependencies) {
+        // Only earlier tasks can be depended on, so the graph can't have cycles
+        if (dependency < id) {
+            tasks[dependency].dependents.push_back(id);
+            dependencyCount++;
+        } else {
+            std::cerr << "Startup task " << name << ": ignoring unknown dependency " << dependency
+                      << std::endl;
+        }
+    }
+    tasks.push_back({name, affinity, std::move(work), {}, dependencyCount, false,
+                     TaskState::Pending, 0.0, 0.0});
+    return id;
+}
+
+double TaskGraph::Now() const {
+    return std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+}
+
+bool TaskGraph::Run(size_t maxWorkers) {
+    runStart = Clock::now();
+
+    size_t workerTasks = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        unfinished = tasks.size();
+        for (TaskId id = 0; id < tasks.size(); id++) {
+            if (tasks[id].affinity == Affinity::Worker) {
+                workerTasks++;
+            }
+            if (tasks[id].remainingDeps == 0) {
+                (tasks[id].affinity == Affinity::Main ? readyMain : readyWorker).push_back(id);
+            }
+        }
+    }
+
+    // No point in more threads than there is worker-side work
+    if (maxWorkers == 0) {
+        maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::thread> workers;
+    try {
+        for (size_t i = 0; i < std::min(maxWorkers, workerTasks); i++) {
+            workers.emplace_back(&TaskGraph::WorkerLoop, this);
+        }
+    } catch (const std::system_error& e) {
+        // Fewer workers only slows startup; with none, the caller runs their tasks too
+        std::cerr << "Startup task graph: only " << workers.size()
+                  << " worker threads started: " << e.what() << std::endl;
+    }
+
+    // Workers must never outlive Run(), so anything escaping the main loop stops
+    // them before they are joined
+    bool completed = true;
+    try {
+        MainLoop(workers.empty());
+    } catch (...) {
+        std::cerr << "Startup task graph aborted" << std::endl;
+        completed = false;
+        std::lock_guard<std::mutex> lock(mutex);
+        aborted = true;
+        readySignal.notify_all();
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    wallMs = Now();
+
+    return completed && std::all_of(tasks.begin(), tasks.end(), [](const Task& task) {
+               return task.state == TaskState::Done;
+           });
+}
+
+void TaskGraph::MainLoop(bool runWorkerTasks) {
+    // The calling thread services main-affinity tasks until everything is done
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        readySignal.wait(lock, [this, runWorkerTasks] {
+            return !readyMain.empty() || (runWorkerTasks && !readyWorker.empty()) ||
+                   unfinished == 0;
+        });
+        std::deque<TaskId>& ready = !readyMain.empty() ? readyMain : readyWorker;
+        if (ready.empty()) {
+            return;
+        }
+        TaskId id = ready.front();
+        ready.pop_front();
+        lock.unlock();
+        Execute(id);
+        lock.lock();
+    }
+}
+
+void TaskGraph::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        readySignal.wait(lock,
+                         [this] { return !readyWorker.empty() || unfinished == 0 || aborted; });
+        if (readyWorker.empty() || aborted) {
+            return;
+        }
+        TaskId id = readyWorker.front();
+        readyWorker.pop_front();
+        lock.unlock();
+        Execute(id);
+        lock.lock();
+    }
+}
+
+void TaskGraph::Execute(TaskId id) {
+    Task& task = tasks[id];
+    task.startMs = Now();
+
+    bool ok = false;
+    try {
+        ok = task.work();
+    } catch (const std::exception& e) {
+        std::cerr << "Startup task " << task.name << " threw: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Startup task " << task.name << " threw a non-standard exception"
+                  << std::endl;
+    }
+    task.endMs = Now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Finish(id, ok ? TaskState::Done : TaskState::Failed);
+}
+
+void TaskGraph::Finish(TaskId id, TaskState state) {
+    Task& task = tasks[id];
+    task.state = state;
+    unfinished--;
+
+    for (TaskId dependentId : task.dependents) {
+        Task& dependent = tasks[dependentId];
+        dependent.blocked |= state != TaskState::Done;
+        if (--dependent.remainingDeps > 0) {
+            continue;
+        }
+        if (dependent.blocked) {
+            dependent.startMs = dependent.endMs = task.endMs;
+            Finish(dependentId, TaskState::Skipped);
+        } else {
+            (dependent.affinity == Affinity::Main ? readyMain : readyWorker).push_back(dependentId);
+        }
+    }
+    readySignal.notify_all();
+}
+
+void TaskGraph::PrintTimings(std::ostream& out) const {
+    size_t nameWidth = 4;
+    for (const Task& task : tasks) {
+        nameWidth = std::max(nameWidth, task.name.size());
+    }
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << "Startup tasks (" << wallMs << " ms wall):" << std::endl;
+    for (const Task& task : tasks) {
+        out << "  " << std::left << std::setw(static_cast<int>(nameWidth)) << task.name << std::right
+            << (task.affinity == Affinity::Main ? "  main  " : "  worker")
+            << std::setw(8) << task.startMs << " ->" << std::setw(7) << task.endMs << " ms"
+            << std::setw(8) << task.endMs - task.startMs << " ms  " << StateName(task.state)
+            << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}